@@ -0,0 +1,141 @@
+#ifndef ASYNC_READER_H
+#define ASYNC_READER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// Asynchronous sequential reader
+// ============================================================================
+
+/**
+ * Alignment of the buffers, and of offsets / lengths with O_DIRECT
+ */
+constexpr uint64_t ASYNC_READ_ALIGNMENT = 4096;
+
+/**
+ * Buffer pool and queue of an AsyncFileReader
+ */
+struct AsyncReadOptions {
+    uint64_t bufferBytes = 1ULL << 20;  // size of each buffer (one read)
+    uint64_t queueDepth = 4;            // buffers, i.e. reads in flight
+    bool direct = false;                // O_DIRECT (bypasses the page cache)
+    bool useIoUring = true;             // false: pread thread only
+};
+
+/**
+ * Options used by the CSV loaders and the out-of-core scans
+ * (set once from the command line)
+ */
+AsyncReadOptions& asyncReadDefaults();
+
+class IoUring;
+
+/**
+ * Reads a byte range of a file front to back, queueDepth reads ahead of the
+ * consumer, into a fixed pool of aligned buffers. With io_uring the buffers
+ * are registered with the kernel and the reads are submitted from the
+ * consumer thread; otherwise one thread issues the preads
+ *
+ * Chunks are returned in file order: next() hands out the following one,
+ * which stays valid until release() gives its buffer back for a new read
+ */
+class AsyncFileReader {
+public:
+    AsyncFileReader();
+    ~AsyncFileReader();
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    /**
+     * Starts reading [offset, offset + length) of path (length 0: up to the
+     * end of the file). O_DIRECT is dropped, with a warning, when the file
+     * system or the alignment of offset / bufferBytes does not allow it
+     */
+    bool open(const std::string& path, const AsyncReadOptions& options, uint64_t offset = 0, uint64_t length = 0);
+
+    /**
+     * Next chunk (at most bufferBytes). Returns false at the end of the
+     * range or on a read error (see failed())
+     */
+    bool next(const char*& data, uint64_t& size);
+
+    /**
+     * Returns the buffer of the last chunk to the pool
+     */
+    void release();
+
+    bool failed() const { return failed_; }
+    uint64_t bytesRead() const { return bytesRead_; }
+    bool direct() const { return options_.direct; }
+
+    /**
+     * "io_uring (registered buffers)", "io_uring" or "pread"
+     */
+    const char* backend() const;
+
+private:
+    enum class SlotState { Free, Reading, Done };
+    struct Slot {
+        char* buffer = nullptr;
+        uint64_t chunk = 0;
+        int64_t result = 0;
+        SlotState state = SlotState::Free;
+    };
+
+    uint64_t chunkSize(uint64_t chunk) const;
+    uint64_t requestSize(uint64_t chunk) const;
+    void submit(uint64_t chunk);
+    bool waitFor(Slot& slot);
+    bool completeShortRead(Slot& slot);
+    void preadLoop();
+    void close();
+
+    std::string path_;
+    AsyncReadOptions options_;
+    int fd_ = -1;
+    uint64_t offset_ = 0;
+    uint64_t length_ = 0;
+    uint64_t numChunks_ = 0;
+    uint64_t nextChunk_ = 0;
+    uint64_t bytesRead_ = 0;
+    bool holding_ = false;
+    bool failed_ = false;
+    std::vector<Slot> slots_;
+    void* pool_ = nullptr;
+
+    // io_uring backend
+    std::unique_ptr<IoUring> ring_;
+    bool registered_ = false;
+
+    // pread backend
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+
+/**
+ * std::streambuf over an AsyncFileReader, so that line-based parsers
+ * (std::getline on an std::istream) read from its buffers without a copy
+ */
+class AsyncStreamBuf : public std::streambuf {
+public:
+    explicit AsyncStreamBuf(AsyncFileReader& reader) : reader_(reader) {}
+    ~AsyncStreamBuf() override;
+
+protected:
+    int_type underflow() override;
+
+private:
+    AsyncFileReader& reader_;
+    bool holding_ = false;
+};
+
+#endif // ASYNC_READER_H
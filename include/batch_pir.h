@@ -0,0 +1,139 @@
+#ifndef BATCH_PIR_H
+#define BATCH_PIR_H
+
+#include "pir_kernels.h"
+#include "pir/database.h"
+#include "pir/mat.h"
+#include "pir/pir.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ============================================================================
+// PIR configuration
+// ============================================================================
+
+/**
+ * Options forwarded to every VLHEPIR built by the composite modes
+ */
+struct PIRConfig {
+    bool allowTrivial = true;
+    bool verbose = false;
+    bool simplePIR = false;
+    uint64_t batchSize = 1;
+    bool honestHint = false;
+};
+
+// ============================================================================
+// Cuckoo-hashing batch code
+// ============================================================================
+
+/**
+ * 64-bit mixing function (splitmix64 finalizer) used by the hash tables
+ */
+inline uint64_t mix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Probabilistic batch code: every index is replicated into numHashes
+ * candidate buckets, and any set of k indices can be assigned to distinct
+ * buckets by cuckoo hashing (with high probability for 1.5k buckets)
+ */
+class BatchCode {
+public:
+    uint64_t N = 0;
+    uint64_t numBuckets = 0;
+    uint64_t numHashes = 3;
+    uint64_t seed = 0;
+    std::vector<std::vector<uint64_t>> buckets;   // bucket -> sorted indices
+
+    BatchCode() = default;
+    BatchCode(uint64_t N, uint64_t k, uint64_t numHashes = 3, uint64_t seed = 0x5eed5eed);
+
+    /**
+     * j-th candidate bucket of index (candidates may coincide)
+     */
+    uint64_t bucketOf(uint64_t index, uint64_t j) const;
+
+    /**
+     * Position of index inside the sub-database of bucket
+     */
+    uint64_t positionIn(uint64_t bucket, uint64_t index) const;
+
+    /**
+     * Assigns each index to one of its candidate buckets, at most one index
+     * per bucket. Returns false if cuckoo insertion fails
+     * assignment[b] = index stored in bucket b, or UINT64_MAX if unused
+     */
+    bool assign(const std::vector<uint64_t>& indices, std::vector<uint64_t>& assignment) const;
+};
+
+// ============================================================================
+// Batch PIR server and client
+// ============================================================================
+
+/**
+ * One PIR instance per bucket, answered together in one parallel pass
+ */
+struct BatchBucket {
+    std::unique_ptr<VLHEPIR> pir;
+    PIRKernels kernels;
+    KernelMatrix D;
+    Matrix A;
+    Matrix H;
+};
+
+class BatchPIRServer {
+public:
+    BatchCode code;
+    std::vector<BatchBucket> buckets;
+
+    /**
+     * Splits db into the sub-databases of code and runs their offline phases
+     */
+    BatchPIRServer(const Database& db, uint64_t d, const BatchCode& code, const PIRConfig& config = PIRConfig());
+
+    /**
+     * Answers one query per bucket in a single pass over all sub-databases
+     */
+    std::vector<Matrix> Answer(const std::vector<Matrix>& cts, uint64_t numThreads = 0) const;
+
+    /**
+     * Server work relative to one scan of the full database
+     */
+    double scanOverhead() const;
+};
+
+class BatchPIRClient {
+public:
+    /**
+     * Builds one query per bucket for the given indices (dummy queries for
+     * unused buckets, so the server cannot tell which buckets matter)
+     * Returns false if the indices could not be assigned to buckets
+     */
+    bool Query(const BatchPIRServer& server, const std::vector<uint64_t>& indices);
+
+    /**
+     * Recovers the requested entries, in the order of Query's indices
+     */
+    std::vector<entry_t> Recover(const BatchPIRServer& server, const std::vector<Matrix>& answers) const;
+
+    std::vector<Matrix> cts;
+
+private:
+    std::vector<uint64_t> indices_;
+    std::vector<uint64_t> assignment_;
+    std::vector<Matrix> sks_;
+};
+
+/**
+ * Runs the batch pipeline on db for the given indices and prints timings
+ * Returns false if any recovered entry does not match the database
+ */
+bool runBatchPIR(const Database& db, uint64_t d, const std::vector<uint64_t>& indices, const PIRConfig& config = PIRConfig());
+
+#endif // BATCH_PIR_H
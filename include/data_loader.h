@@ -1,9 +1,12 @@
 #ifndef DATA_LOADER_H
 #define DATA_LOADER_H
 
+#include "db_layout.h"
 #include "pir/database.h"
 #include "pir/pir.h"
+#include <memory>
 #include <string>
+#include <vector>
 #include <cstdint>
 
 // ============================================================================
@@ -29,6 +32,27 @@ bool validateColumnForD(const std::string& csvFilePath,
                         uint64_t d,
                         bool hasHeader = true);
 
+/**
+ * Result of a single pass over a data column
+ * (line count, value range, validation against d)
+ */
+struct ColumnScan {
+    uint64_t N = 0;
+    uint64_t minValue = UINT64_MAX;
+    uint64_t maxValue = 0;
+    uint64_t d = 0;      // d used for validation, or inferred from maxValue
+    bool valid = false;
+};
+
+/**
+ * Counts, validates and computes the value range of the first CSV column
+ * in one pass. If d = 0, no validation is done and d is inferred from the
+ * column's maximum. Dedicated paths exist for d in {1, 2, 4, 8, 16, 32}
+ */
+ColumnScan scanCSVColumn(const std::string& csvFilePath,
+                         uint64_t d,
+                         bool hasHeader = true);
+
 // ============================================================================
 // Database loading functions
 // ============================================================================
@@ -49,7 +73,7 @@ bool loadDatabaseFromCSV(Database& db,
 
 /**
  * Creates a VLHEPIR from a CSV file
- * Automatically determines N, d must be specified
+ * Automatically determines N, d = 0 infers d from the column's maximum
  */
 VLHEPIR createVLHEPIRFromCSV(const std::string& csvFilePath,
                              uint64_t d,
@@ -61,11 +85,58 @@ VLHEPIR createVLHEPIRFromCSV(const std::string& csvFilePath,
                              bool honestHint = false);
 
 /**
- * Prints statistics about a CSV file
+ * Same, from the scanCSVColumn result of the file (no second scan)
  */
-void printCSVStats(const std::string& csvFilePath,
-                   uint64_t d,
-                   bool hasHeader = true);
+VLHEPIR createVLHEPIRFromCSV(const std::string& csvFilePath,
+                             const ColumnScan& scan,
+                             bool hasHeader = true,
+                             bool allowTrivial = true,
+                             bool verbose = false,
+                             bool simplePIR = false,
+                             uint64_t batchSize = 1,
+                             bool honestHint = false);
+
+/**
+ * Prints statistics about a CSV file from its scanCSVColumn result
+ */
+void printCSVStats(const std::string& csvFilePath, const ColumnScan& scan);
+
+// ============================================================================
+// Streaming ingest (stdin, pipes)
+// ============================================================================
+
+/**
+ * Values of a column whose length is only known at the end of the stream,
+ * kept in fixed-size chunks: growing adds a chunk and never moves the
+ * values already read
+ */
+struct ChunkedColumn {
+    std::vector<std::vector<uint64_t>> chunks;
+    uint64_t size = 0;
+    uint64_t maxValue = 0;
+
+    void push(uint64_t value);
+};
+
+/**
+ * Reads the first CSV column from a descriptor (stdin, a pipe: no seek,
+ * no counting pass) up to the end of the stream. Values must be in
+ * [0, 2^d-1] (d = 0: no check)
+ */
+bool readCSVStream(ChunkedColumn& column, int fd, uint64_t d, bool hasHeader = true);
+
+/**
+ * Creates a VLHEPIR from a CSV stream: N (and d, if 0) are known at the
+ * end of the stream, then each chunk is copied into db.data and freed
+ */
+VLHEPIR createVLHEPIRFromStream(int fd,
+                                uint64_t d,
+                                bool hasHeader = true,
+                                bool allowTrivial = true,
+                                bool verbose = false,
+                                bool simplePIR = false,
+                                uint64_t batchSize = 1,
+                                bool honestHint = false);
 
 // ============================================================================
 // Functions for Parquet files
@@ -83,6 +154,14 @@ bool validateParquetColumnForD(const std::string& parquetFilePath,
                                uint64_t d,
                                const std::string& columnName = "");
 
+/**
+ * Counts, validates and computes the value range of a Parquet column
+ * in one pass (d = 0: infer d from the column's maximum)
+ */
+ColumnScan scanParquetColumn(const std::string& parquetFilePath,
+                             uint64_t d,
+                             const std::string& columnName = "");
+
 /**
  * Loads Parquet column data into a Database
  */
@@ -93,7 +172,7 @@ bool loadDatabaseFromParquet(Database& db,
                              uint64_t maxRows = 0);
 
 /**
- * Creates a VLHEPIR from a Parquet file
+ * Creates a VLHEPIR from a Parquet file (d = 0: infer d)
  */
 VLHEPIR createVLHEPIRFromParquet(const std::string& parquetFilePath,
                                  uint64_t d,
@@ -118,7 +197,16 @@ enum class FileFormat { CSV, PARQUET, UNKNOWN };
 FileFormat detectFileFormat(const std::string& filePath);
 
 /**
- * Creates a VLHEPIR from a file (automatic format detection)
+ * Scans a CSV or Parquet column (automatic format detection)
+ */
+ColumnScan scanColumn(const std::string& filePath,
+                      uint64_t d,
+                      const std::string& columnName = "",
+                      bool hasHeader = true);
+
+/**
+ * Creates a VLHEPIR from a file (automatic format detection, d = 0: infer d,
+ * "-": CSV read from standard input)
  */
 VLHEPIR createVLHEPIRFromFile(const std::string& filePath,
                               uint64_t d,
@@ -130,6 +218,139 @@ VLHEPIR createVLHEPIRFromFile(const std::string& filePath,
                               uint64_t batchSize = 1,
                               bool honestHint = false);
 
+// ============================================================================
+// Locality-aware (grouped) layout
+// ============================================================================
+
+/**
+ * Reads the grouping key of every record from a CSV column, selected by
+ * header name or by 0-based position when keyColumn is a number
+ */
+bool readCSVKeyColumn(std::vector<std::string>& keys,
+                      const std::string& csvFilePath,
+                      const std::string& keyColumn,
+                      bool hasHeader = true);
+
+/**
+ * Reads the grouping key of every record from a Parquet column
+ */
+bool readParquetKeyColumn(std::vector<std::string>& keys,
+                          const std::string& parquetFilePath,
+                          const std::string& keyColumn);
+
+/**
+ * Reads a key column (automatic format detection)
+ */
+bool readKeyColumn(std::vector<std::string>& keys,
+                   const std::string& filePath,
+                   const std::string& keyColumn,
+                   bool hasHeader = true);
+
+/**
+ * Loads a value column and a key column in record order
+ * d = 0 is resolved from the column's maximum; returns nullptr on failure
+ */
+std::unique_ptr<Database> loadRecordsWithKeys(const std::string& filePath,
+                                              uint64_t& d,
+                                              const std::string& keyColumn,
+                                              std::vector<std::string>& keys,
+                                              const std::string& columnName = "",
+                                              bool hasHeader = true);
+
+/**
+ * Creates a VLHEPIR whose index layout keeps the records sharing a key
+ * in the same database column(s), so a group is fetched with one query
+ * map receives the record -> position mapping to publish to clients
+ */
+VLHEPIR createGroupedVLHEPIRFromFile(const std::string& filePath,
+                                     uint64_t d,
+                                     const std::string& keyColumn,
+                                     IndexMap& map,
+                                     const std::string& columnName = "",
+                                     bool hasHeader = true,
+                                     bool allowTrivial = true,
+                                     bool verbose = false,
+                                     bool simplePIR = false,
+                                     uint64_t batchSize = 1,
+                                     bool honestHint = false);
+
+// ============================================================================
+// Record mode (several columns per entry)
+// ============================================================================
+
+/**
+ * One column of a record: bits [offset, offset + d) of the entry
+ */
+struct RecordField {
+    std::string name;
+    uint64_t d = 0;       // 0 = inferred from the column's maximum
+    uint64_t offset = 0;
+};
+
+/**
+ * Layout of a whole record packed into one database entry
+ * (first field in the low bits)
+ */
+struct RecordSchema {
+    std::vector<RecordField> fields;
+
+    uint64_t totalBits() const;
+
+    /**
+     * Parses "name[:d],name[:d],..." (d omitted = inferred)
+     */
+    static bool parse(const std::string& spec, RecordSchema& schema);
+
+    /**
+     * Splits a recovered entry into its field values
+     */
+    std::vector<uint64_t> split(const entry_t& entry) const;
+};
+
+/**
+ * Reads several numeric columns of a CSV file in one pass, selected by
+ * header name or by 0-based position
+ */
+bool readCSVColumns(std::vector<std::vector<uint64_t>>& columns,
+                    const std::string& csvFilePath,
+                    const std::vector<std::string>& names,
+                    bool hasHeader = true);
+
+/**
+ * Same as readCSVColumns for the complete lines (ending with a newline)
+ * starting at byte offset (0: after the header). offset is moved past the
+ * last line read, so that the next call only reads rows appended since;
+ * lineNumber (data lines before offset) moves with it and numbers the
+ * lines in errors as readCSVColumns does
+ */
+bool readCSVColumnsFrom(std::vector<std::vector<uint64_t>>& columns,
+                        const std::string& csvFilePath,
+                        const std::vector<std::string>& names,
+                        bool hasHeader,
+                        uint64_t& offset,
+                        uint64_t& lineNumber);
+
+/**
+ * Reads several numeric (INT64 / UINT64) columns of a Parquet file
+ */
+bool readParquetColumns(std::vector<std::vector<uint64_t>>& columns,
+                        const std::string& parquetFilePath,
+                        const std::vector<std::string>& names);
+
+/**
+ * Creates a VLHEPIR whose entries are whole records: the fields of schema
+ * are concatenated (at most 64 bits in total), so one query returns all
+ * columns of a row. Inferred widths and offsets are filled in schema
+ */
+VLHEPIR createRecordVLHEPIRFromFile(const std::string& filePath,
+                                    RecordSchema& schema,
+                                    bool hasHeader = true,
+                                    bool allowTrivial = true,
+                                    bool verbose = false,
+                                    bool simplePIR = false,
+                                    uint64_t batchSize = 1,
+                                    bool honestHint = false);
+
 // ============================================================================
 // Functions for generating random databases
 // ============================================================================
@@ -147,4 +368,10 @@ VLHEPIR createVLHEPIRFromRandomData(uint64_t N,
                                     uint64_t batchSize = 1,
                                     bool honestHint = false);
 
+/**
+ * Allocates db.data if needed and fills it with random d-bit values
+ * (for pipelines that need the entries in random generation mode)
+ */
+void fillRandomDatabase(Database& db, uint64_t d, uint64_t seed);
+
 #endif // DATA_LOADER_H
\ No newline at end of file
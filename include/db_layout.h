@@ -0,0 +1,92 @@
+#ifndef DB_LAYOUT_H
+#define DB_LAYOUT_H
+
+#include "pir/pir.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Database matrix layout
+// ============================================================================
+
+/**
+ * Placement of database entries in the ell x m matrix D, mirroring
+ * Database::packDataInMatrix: entries fill D column by column, so one
+ * column (the unit returned by one Answer) holds consecutive indices
+ *
+ * - d <= log2 p: entriesPerElem entries share one Z_p digit (low bits first)
+ * - d >  log2 p: one entry spans elemsPerEntry consecutive digits (low first)
+ */
+struct DBLayout {
+    uint64_t N = 0;
+    uint64_t d = 0;
+    uint64_t ell = 0;
+    uint64_t m = 0;
+    uint64_t p = 0;
+    uint64_t bitsPerElem = 0;      // floor(log2 p)
+    uint64_t entriesPerElem = 1;
+    uint64_t elemsPerEntry = 1;
+    uint64_t entriesPerColumn = 0;
+
+    /**
+     * Builds the layout of a PIR instance
+     */
+    static DBLayout fromParams(const DBParams& params);
+
+    /**
+     * Builds the layout for explicit dimensions
+     */
+    static DBLayout make(uint64_t N, uint64_t d, uint64_t ell, uint64_t m, uint64_t p);
+
+    uint64_t columnOf(uint64_t index) const { return index / entriesPerColumn; }
+    uint64_t firstIndexOfColumn(uint64_t column) const { return column * entriesPerColumn; }
+
+    /**
+     * Row of the first digit holding index, and its bit offset in that digit
+     */
+    uint64_t rowOf(uint64_t index) const {
+        return ((index % entriesPerColumn) / entriesPerElem) * elemsPerEntry;
+    }
+    uint64_t bitOffsetOf(uint64_t index) const {
+        return ((index % entriesPerColumn) % entriesPerElem) * d;
+    }
+};
+
+// ============================================================================
+// Locality-aware (grouped) index layout
+// ============================================================================
+
+/**
+ * Mapping from record index (row order of the input file) to database
+ * position, published to clients alongside the hint
+ */
+struct IndexMap {
+    uint64_t entriesPerColumn = 0;
+    uint64_t paddedN = 0;                 // positions used, including padding
+    std::vector<uint64_t> positions;      // record -> position
+    std::vector<std::string> keys;        // record -> group key
+
+    uint64_t positionOf(uint64_t record) const { return positions[record]; }
+};
+
+/**
+ * Assigns positions so that records sharing a key are contiguous and a group
+ * never straddles a column boundary: a group that fits in the rest of the
+ * current column goes there, otherwise it starts on the next column
+ * (groups larger than a column span whole columns)
+ * Groups are placed in order of first appearance
+ */
+IndexMap buildGroupedLayout(const std::vector<std::string>& keys, uint64_t entriesPerColumn);
+
+/**
+ * Writes the map as CSV (record,position,group) after a parameter line
+ */
+bool saveIndexMap(const IndexMap& map, const std::string& path);
+
+/**
+ * Reads a map written by saveIndexMap
+ */
+bool loadIndexMap(IndexMap& map, const std::string& path);
+
+#endif // DB_LAYOUT_H
@@ -0,0 +1,50 @@
+#ifndef DISTRIBUTED_HINT_H
+#define DISTRIBUTED_HINT_H
+
+#include "pir_kernels.h"
+#include "pir/mat.h"
+#include "pir/pir.h"
+#include <openssl/sha.h>
+#include <cstdint>
+#include <sys/types.h>
+#include <vector>
+
+// ============================================================================
+// Distributed hint generation
+// ============================================================================
+
+/**
+ * One worker of a distributed hint: its row block of H and how it went
+ */
+struct HintWorker {
+    pid_t pid = -1;
+    int fromWorker = -1;      // pipe carrying the block back
+    uint64_t firstRow = 0;
+    uint64_t rows = 0;
+    double seconds = 0;       // compute time reported by the worker
+    double receiveSeconds = 0;
+    bool ok = false;
+};
+
+/**
+ * Checks H = D * A without recomputing it: with R a random n x k matrix,
+ * H * R must equal D * (A * R). A wrong entry goes unnoticed with
+ * probability at most 2^-k (mod 2^32, an even error can hide half the time)
+ */
+bool checkHintProduct(const PIRKernels& kernels, const KernelMatrix& D, const Matrix& A,
+                      const Matrix& H, uint64_t k = 8);
+
+/**
+ * Computes H = D * A on numWorkers local worker processes (standing in for
+ * nodes), each owning a contiguous block of rows of D and running the
+ * blocked hint kernel on threadsPerWorker threads (0: cores / workers).
+ * Every block comes back over a pipe with the SHA-256 of its bytes. The
+ * coordinator stitches the blocks, checks the result with checkHintProduct,
+ * then computes the HashAandH digest of (A, H) for the proofs.
+ * Returns false if a worker fails or a check does not pass
+ */
+bool generateHintDistributed(VLHEPIR& pir, const PIRKernels& kernels, const KernelMatrix& D,
+                             const Matrix& A, uint64_t numWorkers, uint64_t threadsPerWorker,
+                             Matrix& H, unsigned char digest[SHA256_DIGEST_LENGTH]);
+
+#endif // DISTRIBUTED_HINT_H
@@ -0,0 +1,68 @@
+#ifndef DPF_H
+#define DPF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// Distributed point function (two parties, output in GF(2))
+// ============================================================================
+
+/**
+ * 128-bit seed / output block
+ */
+struct alignas(16) DPFBlock {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    DPFBlock operator^(const DPFBlock& other) const { return {lo ^ other.lo, hi ^ other.hi}; }
+    DPFBlock& operator^=(const DPFBlock& other) {
+        lo ^= other.lo;
+        hi ^= other.hi;
+        return *this;
+    }
+};
+
+/**
+ * Number of domain bits resolved inside one 128-bit leaf (early termination)
+ */
+constexpr uint64_t DPF_LEAF_BITS = 7;
+
+/**
+ * Key of one party for the point function f(alpha) = 1, f(x) = 0 elsewhere
+ * over the domain [0, 2^(depth + DPF_LEAF_BITS)). The XOR of both parties'
+ * full-domain evaluations is the indicator vector of alpha
+ */
+struct DPFKey {
+    uint8_t party = 0;
+    uint32_t depth = 0;
+    DPFBlock seed;
+    std::vector<DPFBlock> seedCW;
+    std::vector<uint8_t> tLeftCW;
+    std::vector<uint8_t> tRightCW;
+    DPFBlock outputCW;
+
+    std::vector<uint8_t> serialize() const;
+    static bool deserialize(const uint8_t* data, size_t size, DPFKey& key);
+};
+
+/**
+ * Tree depth needed for a domain of N points
+ */
+uint32_t dpfDepthForDomain(uint64_t N);
+
+/**
+ * Generates the two keys of the point function at alpha
+ * (AES-128 PRG, seeds from the OpenSSL RNG)
+ */
+void dpfGen(uint64_t alpha, uint32_t depth, DPFKey& key0, DPFKey& key1);
+
+/**
+ * Evaluates key on the whole domain, expanding the tree level by level
+ * with one AES call per level and thread. out receives 2^depth leaves of
+ * 128 bits (bit x of the domain is bit x % 64 of out[x / 64])
+ */
+void dpfEvalFull(const DPFKey& key, std::vector<uint64_t>& out, uint64_t numThreads = 0);
+
+#endif // DPF_H
@@ -0,0 +1,71 @@
+#ifndef ENGINE_COMPARE_H
+#define ENGINE_COMPARE_H
+
+#include "pir/pir.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Side-by-side engine comparison
+// ============================================================================
+
+/**
+ * One full pipeline run under a (simplePIR, honestHint) combination:
+ * time of each phase, size of the server / client state and bytes
+ * exchanged per query
+ */
+struct EngineRun {
+    bool simplePIR = false;
+    bool honestHint = false;
+    DBParams params{};
+
+    // Phase times (ms)
+    double setupMs = 0;      // parameter selection
+    double packMs = 0;       // D and its kernel / proof packings
+    double initMs = 0;       // public matrix A
+    double hintMs = 0;       // H = D * A and its digest
+    double queryMs = 0;
+    double answerMs = 0;
+    double proveMs = 0;      // 0 for SimplePIR
+    double verifyMs = 0;     // 0 for SimplePIR
+    double recoverMs = 0;
+
+    // Memory (bytes)
+    uint64_t serverBytes = 0;  // D, packed D, A and H
+    uint64_t clientBytes = 0;  // A and H
+
+    // Communication (bytes)
+    uint64_t hintBytes = 0;
+    uint64_t queryBytes = 0;
+    uint64_t answerBytes = 0;
+    uint64_t proofBytes = 0;
+
+    bool verified = false;
+    bool correct = false;
+
+    std::string name() const;
+    double onlineMs() const { return queryMs + answerMs + proveMs + verifyMs + recoverMs; }
+};
+
+/**
+ * Prints the runs as one table, phases as rows and engines as columns
+ */
+void printEngineRuns(std::ostream& out, const std::vector<EngineRun>& runs);
+
+/**
+ * Writes the runs as a JSON array
+ */
+void writeEngineRunsJSON(std::ostream& out, const std::vector<EngineRun>& runs);
+
+/**
+ * Runs the whole pipeline for queryIndex under every combination of
+ * simplePIR and honestHint, on the entries already held by pir.db (filled
+ * with random values first if it was not loaded). The entries are shared,
+ * not copied. Prints the table and writes the JSON to jsonPath.
+ * Returns false if a run recovers a wrong value
+ */
+bool runEngineComparison(VLHEPIR& pir, uint64_t queryIndex, const std::string& jsonPath);
+
+#endif // ENGINE_COMPARE_H
@@ -0,0 +1,102 @@
+#ifndef ENGINE_SELECTOR_H
+#define ENGINE_SELECTOR_H
+
+#include "batch_pir.h"
+#include "pir/pir.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Workload and network profile
+// ============================================================================
+
+/**
+ * What the deployment has to serve: query volume, client link and the
+ * guarantees the client requires
+ */
+struct Workload {
+    uint64_t queries = 1;
+    double bandwidthMbps = 100.0;
+    double latencyMs = 20.0;
+    bool requireVerifiable = true;  // excludes SimplePIR (answers are not checked)
+    bool trustHint = false;         // allows the honest-hint variant
+};
+
+// ============================================================================
+// Engines and their estimated cost
+// ============================================================================
+
+enum class Engine { Trivial, SimplePIR, VLHEPIR, HonestHint };
+
+const char* engineName(Engine engine);
+
+/**
+ * Parses auto|trivial|simplepir|vlhepir|honest-hint. Returns false on an
+ * unknown name; isAuto is set for "auto"
+ */
+bool parseEngine(const std::string& name, Engine& engine, bool& isAuto);
+
+/**
+ * Estimated cost of one engine for a workload. Server times are measured
+ * on the engine's own (ell, m, p) shape; transfer times follow from the
+ * byte counts and the network profile
+ */
+struct EngineEstimate {
+    Engine engine = Engine::VLHEPIR;
+    PIRConfig config;
+    DBParams params{};
+    double offlineSeconds = 0;   // hint generation (and its proof)
+    double answerSeconds = 0;    // server work per query (answer and proof)
+    uint64_t hintBytes = 0;      // downloaded once
+    uint64_t uploadBytes = 0;    // per query
+    uint64_t downloadBytes = 0;  // per query
+    double totalSeconds = 0;
+    bool excluded = false;
+    std::string reason;          // why it was excluded
+};
+
+/**
+ * Every candidate, the chosen one and the reasoning behind the choice
+ */
+struct EngineChoice {
+    std::vector<EngineEstimate> candidates;
+    EngineEstimate chosen;
+    bool forced = false;
+    std::vector<std::string> reasoning;
+
+    void print(std::ostream& out, const Workload& workload) const;
+    void writeJSON(std::ostream& out, const Workload& workload) const;
+};
+
+/**
+ * Estimates every engine on a database of N entries of d bits and picks
+ * the cheapest one allowed by the workload. Scans are timed on a sample of
+ * the rows of each candidate's layout (scan time is linear in the rows)
+ */
+EngineChoice selectEngine(uint64_t N, uint64_t d, const Workload& workload, uint64_t numThreads = 0);
+
+/**
+ * Same estimates, but the engine is imposed (the reasoning still shows
+ * how it compares to the cheapest allowed one)
+ */
+EngineChoice selectEngine(uint64_t N, uint64_t d, const Workload& workload, Engine forced, uint64_t numThreads = 0);
+
+/**
+ * Writes the report to path (JSON when path ends in .json, text otherwise)
+ */
+bool saveEngineReport(const EngineChoice& choice, const Workload& workload, const std::string& path);
+
+// ============================================================================
+// Trivial engine
+// ============================================================================
+
+/**
+ * Trivial PIR: the client downloads the whole database, bit-packed, and
+ * reads index locally. pir.db is filled with random values first if it was
+ * not loaded. Returns false on a wrong value
+ */
+bool runTrivialDownload(VLHEPIR& pir, uint64_t queryIndex, const Workload& workload);
+
+#endif // ENGINE_SELECTOR_H
@@ -0,0 +1,27 @@
+#ifndef FUSED_PIR_H
+#define FUSED_PIR_H
+
+#include "batch_pir.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Fused queries over same-shaped databases
+// ============================================================================
+
+/**
+ * Builds one database per column of filePath (all with the same N and d,
+ * hence the same dbParams and A), queries queryIndex in every one of them
+ * with a single ciphertext answered in one fused pass, and prints timings
+ * against separate scans. d = 0 infers d from the largest column
+ * Returns false if a recovered value does not match its database
+ */
+bool runFusedPIR(const std::string& filePath,
+                 const std::vector<std::string>& columns,
+                 uint64_t d,
+                 uint64_t queryIndex,
+                 bool hasHeader = true,
+                 const PIRConfig& config = PIRConfig());
+
+#endif // FUSED_PIR_H
@@ -0,0 +1,44 @@
+#ifndef HINT_BENCH_H
+#define HINT_BENCH_H
+
+#include "pir_kernels.h"
+#include "pir/mat.h"
+#include "pir/pir.h"
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// Hint kernel throughput
+// ============================================================================
+
+/**
+ * One timed H = D * A at a given thread count
+ */
+struct HintRun {
+    uint64_t threads = 0;
+    double seconds = 0;
+    double gflops = 0;  // GFLOP-equivalent: one multiply-add mod 2^32 = 2 operations
+};
+
+/**
+ * Operations (1e9) of H = D * A for a D.rows x D.cols database and n columns of A
+ */
+double hintGigaOps(const KernelMatrix& D, uint64_t n);
+
+/**
+ * Times the cache-blocked hint kernel at 1, 2, 4, ... threads up to
+ * maxThreads (0: all cores), checking each result against H.
+ * Returns an empty vector if one differs
+ */
+std::vector<HintRun> measureHintScaling(const PIRKernels& kernels, const KernelMatrix& D,
+                                        const Matrix& A, const Matrix& H, uint64_t maxThreads = 0);
+
+/**
+ * Compares the library's GenerateHint with the blocked kernel on every
+ * thread count up to maxThreads (0: all cores) and prints throughput, speedup and parallel efficiency.
+ * Returns false if the kernel's hint differs from the library's
+ */
+bool runHintBenchmark(VLHEPIR& pir, const PIRKernels& kernels, const Matrix& D,
+                      const KernelMatrix& D_packed, const Matrix& A, uint64_t maxThreads = 0);
+
+#endif // HINT_BENCH_H
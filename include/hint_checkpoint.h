@@ -0,0 +1,84 @@
+#ifndef HINT_CHECKPOINT_H
+#define HINT_CHECKPOINT_H
+
+#include "pir_kernels.h"
+#include "pir/mat.h"
+#include "pir/pir.h"
+#include <openssl/sha.h>
+#include <cstdint>
+#include <string>
+
+// ============================================================================
+// Checkpoint file
+// ============================================================================
+
+/**
+ * On-disk state of a tiled hint generation: a header (database digest,
+ * shapes, rows done), the public matrix A, then the rows of H completed so
+ * far. Rows are made durable before the header counts them, so a crash at
+ * any point leaves a consistent checkpoint
+ */
+class HintCheckpoint {
+public:
+    explicit HintCheckpoint(const std::string& path) : path_(path) {}
+    ~HintCheckpoint();
+    HintCheckpoint(const HintCheckpoint&) = delete;
+    HintCheckpoint& operator=(const HintCheckpoint&) = delete;
+
+    /**
+     * Loads A and the completed rows of H (rows x A.cols) if path holds a
+     * checkpoint of the database with this digest. Returns false otherwise
+     */
+    bool load(const unsigned char digest[SHA256_DIGEST_LENGTH], uint64_t rows,
+              Matrix& A, Matrix& H, uint64_t& rowsDone);
+
+    /**
+     * Starts a new checkpoint for A, replacing any previous file
+     */
+    bool create(const unsigned char digest[SHA256_DIGEST_LENGTH], uint64_t rows, const Matrix& A);
+
+    /**
+     * Writes rows [firstRow, firstRow + count) of H, then records them as done
+     */
+    bool commit(const Matrix& H, uint64_t firstRow, uint64_t count);
+
+private:
+    bool writeHeader();
+
+    std::string path_;
+    int fd_ = -1;
+    unsigned char digest_[SHA256_DIGEST_LENGTH] = {};
+    uint64_t rows_ = 0;
+    uint64_t m_ = 0;
+    uint64_t n_ = 0;
+    uint64_t rowsDone_ = 0;
+};
+
+// ============================================================================
+// Tiled hint generation
+// ============================================================================
+
+struct HintTiling {
+    uint64_t tileRows = 4096;         // rows of D per tile
+    double checkpointSeconds = 30.0;  // interval between checkpoints
+    uint64_t threads = 0;             // threads of the hint kernel (0: all cores)
+};
+
+/**
+ * SHA-256 of the shape and words of the packed database
+ */
+void digestKernelMatrix(const KernelMatrix& D, unsigned char digest[SHA256_DIGEST_LENGTH]);
+
+/**
+ * H = D * A computed tile by tile over the rows of D, with the completed
+ * tiles checkpointed to path. If path holds a checkpoint of the same
+ * database, A comes from it and generation resumes after its last tile;
+ * otherwise A = pir.Init(). Tiles are computed by the blocked hint kernel
+ * (PIRKernels::hintBlock) and are independent row blocks of an exact
+ * Z_q product, so the result is bit-identical to an uninterrupted run.
+ * Returns false on an I/O error
+ */
+bool generateHintCheckpointed(VLHEPIR& pir, const PIRKernels& kernels, const KernelMatrix& D,
+                              const std::string& path, const HintTiling& tiling, Matrix& A, Matrix& H);
+
+#endif // HINT_CHECKPOINT_H
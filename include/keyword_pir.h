@@ -0,0 +1,112 @@
+#ifndef KEYWORD_PIR_H
+#define KEYWORD_PIR_H
+
+#include "batch_pir.h"
+#include "pir/database.h"
+#include "pir/mat.h"
+#include "pir/pir.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Cuckoo hash table laid out as the PIR database
+// ============================================================================
+
+/**
+ * Public parameters of the keyword table, published with the hint
+ * Slot entries are (fingerprint << d) | value, fingerprint 0 marks an empty slot
+ */
+struct KeywordParams {
+    uint64_t numSlots = 0;
+    uint64_t numHashes = 3;
+    uint64_t seed = 0;
+    uint64_t fingerprintBits = 32;
+    uint64_t d = 0;
+
+    uint64_t entryBits() const { return d + fingerprintBits; }
+    uint64_t slotOf(uint64_t keyHash, uint64_t j) const;
+    uint64_t fingerprintOf(uint64_t keyHash) const;
+};
+
+/**
+ * 64-bit hash of a record identifier
+ */
+uint64_t hashKey(const std::string& key);
+
+/**
+ * Places every key in one of its candidate slots (3-way cuckoo hashing)
+ * slots[s] = record index + 1, or 0 for an empty slot
+ * Retries with new seeds if insertion fails or if a key shares its
+ * fingerprint with another key in one of its candidate slots (the client
+ * would take that key's value); returns false if all seeds fail
+ */
+bool buildKeywordTable(const std::vector<std::string>& keys,
+                       uint64_t d,
+                       KeywordParams& params,
+                       std::vector<uint64_t>& slots);
+
+// ============================================================================
+// Keyword PIR
+// ============================================================================
+
+/**
+ * Creates a VLHEPIR over the cuckoo table of keys -> records->data
+ */
+VLHEPIR createKeywordVLHEPIR(const std::vector<std::string>& keys,
+                             const Database& records,
+                             uint64_t d,
+                             KeywordParams& params,
+                             const PIRConfig& config = PIRConfig());
+
+/**
+ * Creates a VLHEPIR over the cuckoo table built from a key column and a
+ * value column of a CSV or Parquet file
+ */
+VLHEPIR createKeywordVLHEPIRFromFile(const std::string& filePath,
+                                     uint64_t d,
+                                     const std::string& keyColumn,
+                                     KeywordParams& params,
+                                     const std::string& columnName = "",
+                                     bool hasHeader = true,
+                                     const PIRConfig& config = PIRConfig());
+
+/**
+ * Client side: one query per candidate slot, sent as the columns of a
+ * single batched ciphertext so the server answers them in one scan
+ */
+class KeywordPIRClient {
+public:
+    /**
+     * Returns the batched query (m x numHashes) for key
+     */
+    Matrix Query(VLHEPIR& pir, const Matrix& A, const KeywordParams& params, const std::string& key);
+
+    /**
+     * Looks for the key's fingerprint in the decoded slots
+     * Returns false if the key is not in the database
+     */
+    bool Recover(VLHEPIR& pir, const Matrix& H, const Matrix& ans, uint64_t& value) const;
+
+private:
+    KeywordParams params_;
+    uint64_t fingerprint_ = 0;
+    std::vector<uint64_t> slots_;
+    std::vector<Matrix> sks_;
+};
+
+/**
+ * Runs the keyword pipeline on a file for one key and prints timings
+ * Returns false on failure or if the result does not match the file's
+ * records (a key absent from the file matches a slot with probability
+ * about numHashes / 2^fingerprintBits)
+ */
+bool runKeywordPIR(const std::string& filePath,
+                   uint64_t d,
+                   const std::string& keyColumn,
+                   const std::string& queryKey,
+                   const std::string& columnName = "",
+                   bool hasHeader = true,
+                   const PIRConfig& config = PIRConfig());
+
+#endif // KEYWORD_PIR_H
@@ -0,0 +1,131 @@
+#ifndef LIVE_RELOAD_H
+#define LIVE_RELOAD_H
+
+#include "batch_pir.h"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// File watch
+// ============================================================================
+
+/**
+ * Waits for changes to a file or to the files of a directory. Uses inotify
+ * on Linux (on the parent directory of a file, so that a file replaced by
+ * a rename is seen too) and polls sizes and modification times elsewhere
+ */
+class FileWatcher {
+public:
+    FileWatcher() = default;
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool open(const std::string& path);
+
+    /**
+     * Returns true if the path changed within timeoutMs
+     */
+    bool wait(int timeoutMs);
+
+    /**
+     * "inotify" or "polling"
+     */
+    const char* backend() const { return fd_ >= 0 ? "inotify" : "polling"; }
+
+private:
+    uint64_t fingerprint() const;
+
+    std::string path_;
+    std::string name_;  // file name to match in the directory's events ("" for a directory)
+    int fd_ = -1;
+    uint64_t lastFingerprint_ = 0;
+};
+
+// ============================================================================
+// Append ingest
+// ============================================================================
+
+/**
+ * Rows appended to a CSV / Parquet file, or to the files of a directory
+ * (taken in name order), since the previous poll. CSV files are read from
+ * the byte where the previous poll stopped, complete lines only. Parquet
+ * files cannot be appended in place: a rewritten one is read again and the
+ * rows past its previous count are kept
+ */
+class AppendIngestor {
+public:
+    AppendIngestor(const std::string& path, const std::string& column, bool hasHeader = true)
+        : path_(path), column_(column), hasHeader_(hasHeader) {}
+
+    /**
+     * Rows appended since the previous call (every row on the first one)
+     */
+    bool poll(std::vector<uint64_t>& values);
+
+    /**
+     * Latest modification time of the files read by the last poll
+     */
+    std::chrono::system_clock::time_point lastModified() const { return lastModified_; }
+
+private:
+    struct Source {
+        uint64_t offset = 0;  // CSV: bytes consumed
+        uint64_t lines = 0;   // CSV: data lines consumed
+        uint64_t rows = 0;    // Parquet: rows consumed
+    };
+
+    bool pollFile(const std::string& file, std::vector<uint64_t>& values);
+
+    std::string path_;
+    std::string column_;
+    bool hasHeader_;
+    std::map<std::string, Source> sources_;
+    std::chrono::system_clock::time_point lastModified_{};
+};
+
+// ============================================================================
+// Watched server
+// ============================================================================
+
+/**
+ * Reloads of a watched database. Freshness lag runs from the last write to
+ * the input to the new epoch being served. An incremental reload copies the
+ * packed matrix and hint of the serving epoch before updating its columns,
+ * so its time grows with |D| + |H| and not only with the rows appended
+ */
+struct ReloadMetrics {
+    uint64_t incremental = 0;
+    uint64_t full = 0;
+    uint64_t rows = 0;
+    uint64_t rowsDuringRebuild = 0;  // read while a full rebuild was running
+    double incrementalMs = 0;  // includes the copy of D and H: O(|D| + |H|) per reload  // total build time of each kind
+    double fullMs = 0;
+    double maxIncrementalMs = 0;
+    double maxFullMs = 0;
+    double totalLagMs = 0;
+    double maxLagMs = 0;
+
+    void print(std::ostream& out) const;
+};
+
+/**
+ * Serves column of path (a CSV / Parquet file or a directory of them) from
+ * a PIRRegistry and watches it: rows appended to the input are ingested and
+ * published as new epochs (PIRRegistry::Extend, incremental while the
+ * matrix keeps its shape), while a client keeps querying queryIndex and the
+ * newest entry. The matrix has room for reserve * N appended entries
+ * (reserved slots, filled without reshaping) and keeps that much room
+ * each time it has to grow. Runs for seconds (0: until interrupted),
+ * printing one line per reload, then the metrics.
+ * Returns false if an answer does not match the epoch that produced it
+ */
+bool runWatchedPIR(const std::string& path, const std::string& column, uint64_t queryIndex,
+                   double seconds, double reserve = 0, bool hasHeader = true,
+                   const PIRConfig& config = PIRConfig());
+
+#endif // LIVE_RELOAD_H
@@ -0,0 +1,66 @@
+#ifndef PARTITIONED_PIR_H
+#define PARTITIONED_PIR_H
+
+#include "batch_pir.h"
+#include "pir_registry.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Time-partitioned databases
+// ============================================================================
+
+/**
+ * Maps the records of the input to (partition, index inside the partition)
+ * Partitions are named by their key (e.g. the day) or by their file name
+ */
+struct PartitionIndex {
+    std::vector<std::string> names;      // partition names, in first-appearance order
+    std::vector<uint64_t> sizes;         // records per partition
+    std::vector<uint64_t> partitionOf;   // record -> partition
+    std::vector<uint64_t> localIndex;    // record -> index inside its partition
+
+    uint64_t numRecords() const { return partitionOf.size(); }
+};
+
+/**
+ * Builds one PIR instance per distinct value of partitionColumn (same d
+ * for all partitions) and registers them in registry under that value
+ */
+bool buildPartitionsFromColumn(PIRRegistry& registry,
+                               PartitionIndex& index,
+                               const std::string& filePath,
+                               uint64_t d,
+                               const std::string& partitionColumn,
+                               const std::string& columnName = "",
+                               bool hasHeader = true,
+                               const PIRConfig& config = PIRConfig());
+
+/**
+ * Builds one PIR instance per CSV / Parquet file of directory (sorted by
+ * name), registered under the file name without extension. Records are
+ * numbered across files in that order
+ */
+bool buildPartitionsFromDirectory(PIRRegistry& registry,
+                                  PartitionIndex& index,
+                                  const std::string& directory,
+                                  uint64_t d,
+                                  const std::string& columnName = "",
+                                  bool hasHeader = true,
+                                  const PIRConfig& config = PIRConfig());
+
+/**
+ * Queries record queryIndex of the input: only the partition holding it is
+ * scanned. partitionColumn is ignored when path is a directory
+ * Returns false if the recovered value does not match the database
+ */
+bool runPartitionedPIR(const std::string& path,
+                       uint64_t d,
+                       const std::string& partitionColumn,
+                       uint64_t queryIndex,
+                       const std::string& columnName = "",
+                       bool hasHeader = true,
+                       const PIRConfig& config = PIRConfig());
+
+#endif // PARTITIONED_PIR_H
@@ -0,0 +1,70 @@
+#ifndef PIR_CLIENT_H
+#define PIR_CLIENT_H
+
+#include "db_layout.h"
+#include "pir/database.h"
+#include "pir/mat.h"
+#include "pir/pir.h"
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// Column recovery
+// ============================================================================
+
+/**
+ * All entries of the database column decoded from one answer
+ * entries[i] is the entry at index firstIndex + i
+ */
+struct ColumnRecovery {
+    uint64_t column = 0;
+    uint64_t firstIndex = 0;
+    std::vector<entry_t> entries;
+
+    bool contains(uint64_t index) const {
+        return index >= firstIndex && index < firstIndex + entries.size();
+    }
+    const entry_t& at(uint64_t index) const { return entries[index - firstIndex]; }
+};
+
+/**
+ * Decrypts an answer into its ell Z_p digits: round((ans - H * sk) * p / q)
+ * Uses column `col` of ans and sk (for batched queries)
+ */
+std::vector<uint64_t> DecodeDigits(const Matrix& H,
+                                   const Matrix& ans,
+                                   const Matrix& sk,
+                                   uint64_t p,
+                                   uint64_t col = 0);
+
+/**
+ * Recovers every entry sharing the column of queryIndex in one decode pass,
+ * so neighboring records cost a single query
+ */
+ColumnRecovery RecoverColumn(const VLHEPIR& pir,
+                             const Matrix& H,
+                             const Matrix& ans,
+                             const Matrix& sk,
+                             uint64_t queryIndex);
+
+/**
+ * Same as RecoverColumn for an explicit layout
+ */
+ColumnRecovery RecoverColumn(const DBLayout& layout,
+                             const Matrix& H,
+                             const Matrix& ans,
+                             const Matrix& sk,
+                             uint64_t queryIndex);
+
+// ============================================================================
+// Sharded answers
+// ============================================================================
+
+/**
+ * Stacks the partial answers of row-sharded servers, in shard order, into
+ * the answer over the whole database (each part covers the rows following
+ * the previous one). Returns an empty matrix if the column counts differ
+ */
+Matrix ConcatenateAnswers(const std::vector<Matrix>& partials);
+
+#endif // PIR_CLIENT_H
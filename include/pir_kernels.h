@@ -0,0 +1,221 @@
+#ifndef PIR_KERNELS_H
+#define PIR_KERNELS_H
+
+#include "pir/database.h"
+#include "pir/mat.h"
+#include "pir/pir.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Deployed (d, log2 p) combinations
+// ============================================================================
+
+/**
+ * (d, log2 p) pairs for which specialized kernels are instantiated.
+ * Any other combination falls back to the generic runtime kernels.
+ */
+#define PIR_DEPLOYED_CONFIGS(X) \
+    X(1, 8)                     \
+    X(1, 9)                     \
+    X(1, 10)                    \
+    X(1, 11)                    \
+    X(1, 12)                    \
+    X(8, 8)                     \
+    X(8, 10)                    \
+    X(8, 12)                    \
+    X(16, 12)                   \
+    X(16, 16)                   \
+    X(32, 16)
+
+/**
+ * Entry bit sizes d with dedicated parse / validate / load paths
+ */
+#define PIR_DEPLOYED_WIDTHS(X) \
+    X(1)                       \
+    X(2)                       \
+    X(4)                       \
+    X(8)                       \
+    X(16)                      \
+    X(32)
+
+// ============================================================================
+// Bit-packed database matrix
+// ============================================================================
+
+/**
+ * Row-major bit-packed copy of the database matrix D
+ * Each 64-bit word holds 64 / logp consecutive Z_p digits of one row
+ */
+struct KernelMatrix {
+    uint64_t rows = 0;
+    uint64_t cols = 0;
+    uint64_t logp = 0;
+    uint64_t digitsPerWord = 0;
+    uint64_t wordsPerRow = 0;
+    std::vector<uint64_t> words;
+    const uint64_t* external = nullptr;  // rows held elsewhere (e.g. an I/O buffer) instead of words
+
+    const uint64_t* data() const { return external ? external : words.data(); }
+};
+
+/**
+ * Several same-shaped KernelMatrix interleaved word by word, so that one
+ * pass over the query answers all of them: words[(r * wordsPerRow + w) * numDatabases + k]
+ * is word w of row r of database k
+ */
+struct FusedKernelMatrix {
+    uint64_t numDatabases = 0;
+    uint64_t rows = 0;
+    uint64_t cols = 0;
+    uint64_t logp = 0;
+    uint64_t digitsPerWord = 0;
+    uint64_t wordsPerRow = 0;
+    std::vector<uint64_t> words;
+};
+
+/**
+ * Interleaves packed databases sharing the same shape and digit width
+ * Returns false (with a message) if the shapes differ
+ */
+bool fuseKernelMatrices(const std::vector<const KernelMatrix*>& Ds, FusedKernelMatrix& fused);
+
+/**
+ * Cache blocking of the hint product H = D * A: A is swept in panels of
+ * HINT_BLOCK_COLS columns by as many rows as fit in HINT_BLOCK_BYTES (L2),
+ * and every row of D is multiplied by the panel while it is resident
+ */
+constexpr uint64_t HINT_BLOCK_COLS = 256;
+constexpr uint64_t HINT_BLOCK_BYTES = 256ULL << 10;
+
+/**
+ * Copies ct into a buffer padded to a whole number of packed words,
+ * so the inner loops never need a bound check on the last word
+ */
+std::vector<Elem> padQuery(const Matrix& ct, uint64_t paddedRows);
+
+/**
+ * Number of bits needed to store a digit in [0, p-1]
+ */
+uint64_t digitBitsForModulus(uint64_t p);
+
+// ============================================================================
+// Specialized kernels
+// ============================================================================
+
+/**
+ * Kernels specialized on the digit width LogP = ceil(log2 p)
+ * Digits per word, shifts and masks are compile-time constants
+ */
+template <uint64_t LogP>
+struct FixedKernel {
+    static_assert(LogP >= 1 && LogP <= 32, "digit width must be in [1, 32]");
+    static constexpr uint64_t kDigitsPerWord = 64 / LogP;
+    static constexpr uint64_t kDigitMask = (1ULL << LogP) - 1;
+
+    static KernelMatrix pack(const Matrix& D, uint64_t logp);
+    static void answerRows(Elem* out, const KernelMatrix& D, const Elem* ct,
+                           uint64_t batch, uint64_t rowBegin, uint64_t rowEnd);
+    static void answerRowsFused(Elem* out, const FusedKernelMatrix& D, const Elem* ct,
+                                uint64_t batch, uint64_t rowBegin, uint64_t rowEnd);
+    static void hintRows(Elem* out, const KernelMatrix& D, const Elem* A,
+                         uint64_t n, uint64_t rowBegin, uint64_t rowEnd);
+};
+
+/**
+ * Value loader specialized on the entry bit size D
+ * The maximum value check is a constant comparison, values above
+ * 2^D-1 are clamped with a warning (as in loadDatabaseFromCSV)
+ */
+template <uint64_t D>
+struct FixedLoader {
+    static_assert(D >= 1 && D <= 64, "entry bit size must be in [1, 64]");
+    static constexpr uint64_t kMaxValue = (D == 64) ? UINT64_MAX : ((1ULL << D) - 1);
+
+    static void load(Database& db, uint64_t offset, const uint64_t* values, uint64_t count, uint64_t d);
+};
+
+// ============================================================================
+// Runtime dispatcher
+// ============================================================================
+
+/**
+ * Set of kernels selected for a given (d, p)
+ */
+struct PIRKernels {
+    uint64_t d = 0;
+    uint64_t logp = 0;
+    bool specialized = false;
+
+    // Runtime d / logp arguments are ignored by the specialized instances
+    KernelMatrix (*packFn)(const Matrix& D, uint64_t logp) = nullptr;
+    void (*answerRows)(Elem* out, const KernelMatrix& D, const Elem* ct,
+                       uint64_t batch, uint64_t rowBegin, uint64_t rowEnd) = nullptr;
+    void (*answerRowsFused)(Elem* out, const FusedKernelMatrix& D, const Elem* ct,
+                            uint64_t batch, uint64_t rowBegin, uint64_t rowEnd) = nullptr;
+    void (*hintRows)(Elem* out, const KernelMatrix& D, const Elem* A,
+                     uint64_t n, uint64_t rowBegin, uint64_t rowEnd) = nullptr;
+    void (*loadFn)(Database& db, uint64_t offset, const uint64_t* values, uint64_t count, uint64_t d) = nullptr;
+
+    /**
+     * Bit-packs the database matrix D (digits in [0, p-1])
+     */
+    KernelMatrix pack(const Matrix& D) const { return packFn(D, logp); }
+
+    /**
+     * Stores count values in db.data starting at offset
+     */
+    void load(Database& db, uint64_t offset, const uint64_t* values, uint64_t count) const {
+        loadFn(db, offset, values, count, d);
+    }
+
+    /**
+     * Computes ans = D * ct, splitting the rows of D across threads
+     */
+    Matrix answer(const KernelMatrix& D, const Matrix& ct, uint64_t numThreads = 0) const;
+
+    /**
+     * Computes the block.rows rows of D * ct held by block (a slice of the
+     * rows of D) into out, from a query padded by padQuery
+     */
+    void answerBlock(Elem* out, const KernelMatrix& block, const Elem* padded,
+                     uint64_t batch, uint64_t numThreads = 0) const;
+
+    /**
+     * Computes the hint H = D * A (D.rows x A.cols) with the cache-blocked
+     * kernel, splitting the rows of D across threads
+     */
+    Matrix hint(const KernelMatrix& D, const Matrix& A, uint64_t numThreads = 0) const;
+
+    /**
+     * Computes the block.rows rows of D * A held by block into out, from
+     * A padded by padQuery (n = A.cols)
+     */
+    void hintBlock(Elem* out, const KernelMatrix& block, const Elem* padded,
+                   uint64_t n, uint64_t numThreads = 0) const;
+
+    /**
+     * Computes D_k * ct for every database of a fused matrix in one pass,
+     * reading each block of ct once for all databases
+     */
+    std::vector<Matrix> answerFused(const FusedKernelMatrix& D, const Matrix& ct, uint64_t numThreads = 0) const;
+
+    /**
+     * Short description of the selected instance (for logs)
+     */
+    std::string describe() const;
+};
+
+/**
+ * Selects the specialized kernels matching (d, p), or the generic ones
+ * The loader only depends on d, so p may be 0 when only loading
+ */
+PIRKernels selectKernels(uint64_t d, uint64_t p);
+
+/**
+ * Selects the kernels matching the parameters of a PIR instance
+ */
+PIRKernels selectKernels(const DBParams& params);
+
+#endif // PIR_KERNELS_H
@@ -0,0 +1,217 @@
+#ifndef PIR_REGISTRY_H
+#define PIR_REGISTRY_H
+
+#include "batch_pir.h"
+#include "pir_kernels.h"
+#include "pir/mat.h"
+#include "pir/pir.h"
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// Hosted databases
+// ============================================================================
+
+/**
+ * Largest spare capacity of a database, as a fraction of its entries in use
+ */
+constexpr double MAX_RESERVE = 4.0;
+
+/**
+ * Per-database counters, updated by concurrent Answer calls
+ */
+struct DatabaseMetrics {
+    std::atomic<uint64_t> queries{0};
+    std::atomic<uint64_t> answerMicros{0};
+    std::atomic<uint64_t> lastAnswerMicros{0};
+};
+
+/**
+ * One database served by the registry: its PIR instance, packed matrix,
+ * hint and the public matrix A shared with the databases of the same m
+ * and LWE dimension n
+ */
+struct HostedDatabase {
+    std::string name;
+    uint64_t epoch = 0;
+    uint64_t size = 0;     // entries in use, the only indices clients may query: the
+                           // pir->N - size slots after them are reserved (zeros)
+    double reserve = 0;    // spare slots kept when reshaping, as a fraction of size
+    std::unique_ptr<VLHEPIR> pir;
+    PIRKernels kernels;
+    KernelMatrix D;
+    std::shared_ptr<const Matrix> A;
+    Matrix H;
+    mutable DatabaseMetrics metrics;
+    mutable std::atomic<uint64_t> inFlight{0};  // answers running on this epoch
+};
+
+/**
+ * A replaced or unregistered epoch that is still referenced (by running
+ * answers or by clients holding its hint)
+ */
+struct RetiredEpoch {
+    std::string name;
+    uint64_t epoch = 0;
+    uint64_t inFlight = 0;
+};
+
+// ============================================================================
+// Registry of named databases
+// ============================================================================
+
+/**
+ * Hosts many named databases in one process. Databases with the same
+ * number of columns m and LWE dimension n share one public matrix A (and therefore clients
+ * reuse the same query-side state); hints, epochs and metrics are kept per
+ * database. Lookups and answers may run concurrently with registrations
+ *
+ * Every registration is a new epoch: an immutable snapshot (packed matrix,
+ * hint) built outside the lock, then published by swapping one pointer.
+ * Snapshots are reference counted, so answers already running finish on
+ * the epoch they started with, and the previous epoch is freed when its
+ * last reference goes
+ */
+class PIRRegistry {
+public:
+    explicit PIRRegistry(uint64_t numThreads = 0) : numThreads_(numThreads) {}
+
+    /**
+     * Runs the offline phase of pir and serves it under name, replacing any
+     * database of that name. Only the first size entries are in use (0: all
+     * of them), the others are zero slots reserved for Extend; reserve is
+     * the spare capacity kept when Extend has to reshape the matrix
+     * (clamped to [0, MAX_RESERVE]). Queries are private, so the registry
+     * cannot reject an index past size: clients bound their indices by the
+     * size of the snapshot they query, the reserved slots answer zeros.
+     * Returns the new epoch of name (1 for a new one)
+     */
+    uint64_t Register(const std::string& name, std::unique_ptr<VLHEPIR> pir,
+                      uint64_t size = 0, double reserve = 0);
+
+    /**
+     * Register on a background thread: the next epoch of name is built
+     * while the current one keeps serving. The future gives the new epoch
+     */
+    std::future<uint64_t> RegisterAsync(const std::string& name, std::unique_ptr<VLHEPIR> pir,
+                                        uint64_t size = 0, double reserve = 0);
+
+    /**
+     * Appends values to the entries of name as its next epoch. Values go to
+     * the reserved slots while they last, so the matrix keeps its shape
+     * (same d, ell, m, p, n): the packed matrix and hint of the current epoch
+     * are copied and only the columns receiving entries are updated
+     * (H += delta * A). Otherwise the matrix is reshaped for size * (1 +
+     * reserve) entries and the offline phase runs again in full.
+     * incremental (if given) tells which one ran.
+     * Extensions of one name are serialized: each one starts from the
+     * epoch published by the previous one, waiting for its rebuild if it
+     * is still running. The copy of D and H costs O(|D| + |H|) per call.
+     * Returns the new epoch, 0 if name is unknown
+     */
+    uint64_t Extend(const std::string& name, const std::vector<uint64_t>& values,
+                    const PIRConfig& config = PIRConfig(), bool* incremental = nullptr);
+
+    /**
+     * Extend with the full rebuild (if one is needed) on a background
+     * thread, as RegisterAsync: the future is ready on return for an
+     * incremental update
+     */
+    std::shared_future<uint64_t> ExtendAsync(const std::string& name, const std::vector<uint64_t>& values,
+                                             const PIRConfig& config = PIRConfig(), bool* incremental = nullptr);
+
+    /**
+     * Stops serving name. Answers already running keep their snapshot
+     */
+    bool Unregister(const std::string& name);
+
+    /**
+     * Current snapshot of name, or nullptr if unknown
+     */
+    std::shared_ptr<const HostedDatabase> Find(const std::string& name) const;
+
+    /**
+     * Answers ct against the database name. Returns false if unknown,
+     * epoch (if given) receives the epoch that produced ans
+     */
+    bool Answer(const std::string& name, const Matrix& ct, Matrix& ans, uint64_t* epoch = nullptr) const;
+
+    /**
+     * Answers ct on a snapshot returned by Find, whatever the current epoch,
+     * so that the client decodes with the hint of the epoch that answered
+     */
+    void Answer(const HostedDatabase& snapshot, const Matrix& ct, Matrix& ans) const;
+
+    std::vector<std::string> Names() const;
+
+    /**
+     * Number of distinct public matrices A (one per distinct (m, n))
+     */
+    uint64_t NumPublicMatrices() const;
+
+    /**
+     * Epochs no longer served but still referenced
+     */
+    std::vector<RetiredEpoch> RetiredEpochs() const;
+
+    /**
+     * Number of epoch swaps, and the longest time a swap held the lock
+     * (the only time answers can wait on a registration)
+     */
+    uint64_t Swaps() const { return swaps_; }
+    uint64_t MaxSwapMicros() const { return maxSwapMicros_; }
+
+    void PrintMetrics(std::ostream& out) const;
+
+private:
+    /**
+     * Publishes hosted as the next epoch of its name and retires the previous one
+     */
+    uint64_t Publish(std::shared_ptr<HostedDatabase> hosted);
+
+    /**
+     * Serializes the extensions of one name: the last rebuild started by
+     * ExtendAsync, which the next extension waits for
+     */
+    struct Writer {
+        std::mutex mutex;
+        std::shared_future<uint64_t> pending;
+    };
+    std::shared_ptr<Writer> WriterOf(const std::string& name);
+
+    uint64_t numThreads_;
+    std::atomic<uint64_t> swaps_{0};
+    std::atomic<uint64_t> maxSwapMicros_{0};
+    mutable std::shared_mutex mutex_;
+    std::map<std::pair<uint64_t, uint64_t>, std::shared_ptr<const Matrix>> publicMatrices_;  // (m, n) -> A
+    std::map<std::string, std::shared_ptr<const HostedDatabase>> databases_;
+    std::vector<std::weak_ptr<const HostedDatabase>> retired_;
+    std::mutex writersMutex_;
+    std::map<std::string, std::shared_ptr<Writer>> writers_;
+};
+
+/**
+ * Hosts every column of filePath as its own database (d inferred per
+ * column), queries queryIndex in each of them by name and prints the
+ * registry metrics. With reload, the file is then loaded again as the next
+ * epoch of every database while a client keeps querying, and the latency
+ * before / during / after the rebuild is reported.
+ * Returns false if a recovered value does not match
+ */
+bool runRegistryPIR(const std::string& filePath,
+                    const std::vector<std::string>& columns,
+                    uint64_t queryIndex,
+                    bool hasHeader = true,
+                    const PIRConfig& config = PIRConfig(),
+                    bool reload = false);
+
+#endif // PIR_REGISTRY_H
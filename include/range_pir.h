@@ -0,0 +1,54 @@
+#ifndef RANGE_PIR_H
+#define RANGE_PIR_H
+
+#include "batch_pir.h"
+#include "pir/database.h"
+#include "pir/mat.h"
+#include "pir/pir.h"
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// Prefix-sum database
+// ============================================================================
+
+/**
+ * Prefix sums S[i] = x_0 + ... + x_{i-1} (N + 1 entries) of values
+ * Returns false if S[N] does not fit in 64 bits
+ */
+bool computePrefixSums(const std::vector<uint64_t>& values, std::vector<uint64_t>& prefix);
+
+/**
+ * Creates a VLHEPIR over the prefix sums S. prefixD receives the width
+ * chosen for S[N]
+ */
+VLHEPIR createPrefixSumVLHEPIR(const std::vector<uint64_t>& prefix, uint64_t& prefixD,
+                               const PIRConfig& config = PIRConfig());
+
+// ============================================================================
+// Range-sum queries
+// ============================================================================
+
+/**
+ * Client side: sum of x_lo..x_hi (inclusive) = S[hi + 1] - S[lo], with
+ * both point queries sent as one batched ciphertext
+ */
+class RangeSumClient {
+public:
+    Matrix Query(VLHEPIR& pir, const Matrix& A, uint64_t lo, uint64_t hi);
+    uint64_t Recover(VLHEPIR& pir, const Matrix& H, const Matrix& ans) const;
+
+private:
+    uint64_t positions_[2] = {0, 0};
+    Matrix sks_[2];
+};
+
+/**
+ * Runs the range-sum pipeline on values for [lo, hi] and prints timings
+ * values are in record order, lo and hi are record indices
+ * Returns false if the sum overflows 64 bits or does not match the values
+ */
+bool runRangeSumPIR(const std::vector<uint64_t>& values, uint64_t lo, uint64_t hi,
+                    const PIRConfig& config = PIRConfig());
+
+#endif // RANGE_PIR_H
@@ -0,0 +1,148 @@
+#ifndef RECURSIVE_PIR_H
+#define RECURSIVE_PIR_H
+
+#include "db_layout.h"
+#include "pir_kernels.h"
+#include "pir/mat.h"
+#include "pir/pir.h"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// ============================================================================
+// Communication planner
+// ============================================================================
+
+/**
+ * Bytes exchanged by one client: offline hint, and per query upload / download
+ */
+struct CommunicationCost {
+    uint64_t hintBytes = 0;
+    uint64_t uploadBytes = 0;
+    uint64_t downloadBytes = 0;
+
+    uint64_t online() const { return uploadBytes + downloadBytes; }
+    uint64_t total(uint64_t queries) const { return hintBytes + queries * online(); }
+};
+
+/**
+ * Single-level vs two-level costs for one database
+ *
+ * Level 1 is the usual ell1 x m1 scan. Level 2 treats its answer, together
+ * with the level-1 hint rows, as an (1 + n) * kappa x ell1 matrix of base-p2
+ * digits (kappa digits per Z_q element) and runs a second SimplePIR-style
+ * query selecting the column of the wanted row. The client keeps the static
+ * part of the level-2 hint (n * kappa x n, independent of N) instead of the
+ * level-1 hint (ell1 x n), and downloads (1 + n) * kappa + kappa * n elements
+ * instead of ell1
+ */
+struct RecursionPlan {
+    DBLayout level1;
+    uint64_t n = 0;               // LWE dimension (both levels)
+    uint64_t p2 = 0;              // level-2 plaintext modulus
+    uint64_t digitBits = 0;       // log2 p2
+    uint64_t kappa = 0;           // base-p2 digits per Z_q element
+    uint64_t rows2 = 0;           // (1 + n) * kappa
+    CommunicationCost single;
+    CommunicationCost recursive;
+
+    bool winsOnline() const { return recursive.online() < single.online(); }
+    bool winsTotal(uint64_t queries) const { return recursive.total(queries) < single.total(queries); }
+
+    void print(std::ostream& out, uint64_t queries) const;
+};
+
+/**
+ * Plans the recursion for a database of the given parameters and LWE
+ * dimension n. p2 is the largest power of two keeping the level-2 decoding
+ * error below q / (2 p2) with overwhelming probability
+ */
+RecursionPlan planRecursion(const DBParams& params, uint64_t n);
+
+// ============================================================================
+// Second level
+// ============================================================================
+
+// Bytes of the seed A2 is expanded from
+constexpr uint64_t A2_SEED_BYTES = 16;
+
+/**
+ * Public level-2 matrix (rows x cols): AES-128-CTR keystream under seed
+ * The server draws the seed, the client expands the same A2 from it
+ */
+Matrix expandPublicMatrix(const uint8_t* seed, uint64_t rows, uint64_t cols);
+
+/**
+ * Server side of level 2: holds the digits of the level-1 hint (static
+ * part of the level-2 database) and their hint, and answers a level-2
+ * query over a fresh level-1 answer
+ */
+class SecondLevelServer {
+public:
+    /**
+     * Draws a fresh A2 seed (independent of any query) and builds H2
+     */
+    SecondLevelServer(const RecursionPlan& plan, const Matrix& H1);
+
+    /**
+     * Seed of A2 (A2_SEED_BYTES), published with the hint
+     */
+    const uint8_t* seed() const { return seed_; }
+
+    /**
+     * Public level-2 matrix A2 (ell1 x n)
+     */
+    const Matrix& A2() const { return A2_; }
+
+    /**
+     * Static part of the level-2 hint (n * kappa x n), downloaded once
+     */
+    const Matrix& hint() const { return H2_; }
+
+    /**
+     * Answers ct2 over [digits(ans1) ; D2]. ans2 receives the (1 + n) * kappa
+     * answer rows, answerHint the kappa hint rows of the digits of ans1
+     */
+    void Answer(const Matrix& ans1, const Matrix& ct2, Matrix& ans2, Matrix& answerHint) const;
+
+private:
+    RecursionPlan plan_;
+    PIRKernels kernels_;
+    KernelMatrix D2_;
+    uint8_t seed_[A2_SEED_BYTES];
+    Matrix A2_;
+    Matrix H2_;
+};
+
+/**
+ * Client side of the whole recursion
+ */
+class RecursivePIRClient {
+public:
+    explicit RecursivePIRClient(const RecursionPlan& plan) : plan_(plan) {}
+
+    /**
+     * Level-2 query selecting row `row` of the level-1 answer
+     */
+    Matrix Query(const Matrix& A2, uint64_t row);
+
+    /**
+     * Decodes the level-1 answer element and hint row of the queried row,
+     * then the level-1 digit, then the entry at index
+     */
+    entry_t Recover(const Matrix& H2, const Matrix& ans2, const Matrix& answerHint,
+                    const Matrix& sk1, uint64_t index) const;
+
+private:
+    RecursionPlan plan_;
+    Matrix sk2_;
+};
+
+/**
+ * Runs the planner, then a two-level query for queryIndex on pir, and
+ * prints the bytes actually exchanged. pir.db is filled with random
+ * values first if it was not loaded. Returns false on a wrong value
+ */
+bool runRecursivePIR(VLHEPIR& pir, uint64_t queryIndex, uint64_t queries = 1);
+
+#endif // RECURSIVE_PIR_H
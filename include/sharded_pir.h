@@ -0,0 +1,73 @@
+#ifndef SHARDED_PIR_H
+#define SHARDED_PIR_H
+
+#include "pir_kernels.h"
+#include "util.h"
+#include "pir/mat.h"
+#include "pir/pir.h"
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// Row-sharded servers
+// ============================================================================
+
+/**
+ * Rows [firstRow, firstRow + count) of a rows-row matrix held by shard
+ * `shard` of numShards: contiguous blocks, as even as possible
+ */
+void shardRows(uint64_t rows, uint64_t numShards, uint64_t shard, uint64_t& firstRow, uint64_t& count);
+
+/**
+ * One shard's part of an answer: its rows of D * ct
+ */
+struct ShardAnswer {
+    uint64_t firstRow = 0;
+    Matrix ans;
+    uint64_t scanMicros = 0;
+};
+
+/**
+ * A server process holding one row slice of the packed matrix and
+ * answering queries against it over pipes (stands in for one box of a
+ * sharded deployment)
+ */
+class ShardServerProcess {
+public:
+    /**
+     * Forks a server that copies rows [firstRow, firstRow + rows) of D and
+     * keeps only that slice
+     */
+    bool Start(const PIRKernels& kernels, const KernelMatrix& D, uint64_t firstRow,
+               uint64_t rows, uint64_t numThreads = 1);
+
+    /**
+     * Sends a query, the partial answer is read with Receive
+     */
+    bool Send(const Matrix& ct);
+    bool Receive(ShardAnswer& answer);
+
+    void Stop();
+
+    uint64_t firstRow() const { return firstRow_; }
+    uint64_t rows() const { return rows_; }
+    uint64_t sliceBytes() const { return sliceBytes_; }
+
+private:
+    ChildProcess process_;
+    uint64_t firstRow_ = 0;
+    uint64_t rows_ = 0;
+    uint64_t sliceBytes_ = 0;
+};
+
+/**
+ * Answers queryIndex through 1, 2, 4, ... maxShards row-sharded server
+ * processes (threadsPerShard threads each): the query goes to every
+ * shard, the client concatenates the partial answers (ConcatenateAnswers)
+ * and recovers. Prints latency and scaling per shard count. pir.db is
+ * filled with random values first if it was not loaded.
+ * Returns false if a recovered value does not match the database
+ */
+bool runShardedPIR(VLHEPIR& pir, uint64_t queryIndex, uint64_t maxShards, uint64_t threadsPerShard = 1);
+
+#endif // SHARDED_PIR_H
@@ -0,0 +1,98 @@
+#ifndef STREAMING_PIR_H
+#define STREAMING_PIR_H
+
+#include "async_reader.h"
+#include "pir_kernels.h"
+#include "pir/mat.h"
+#include "pir/pir.h"
+#include <cstdint>
+#include <string>
+
+// ============================================================================
+// Packed database on disk
+// ============================================================================
+
+/**
+ * Byte offset of the words in a packed matrix file. The header (shape of
+ * the KernelMatrix) fits in the first page, so the words start page-aligned
+ */
+constexpr uint64_t PACKED_FILE_DATA_OFFSET = 4096;
+
+/**
+ * Writes D to path: shape header, then the words row-major
+ */
+bool writeKernelMatrix(const KernelMatrix& D, const std::string& path);
+
+/**
+ * Timings of one streamed scan
+ */
+struct StreamStats {
+    uint64_t bytesRead = 0;
+    uint64_t blocks = 0;
+    double seconds = 0;         // whole scan
+    double computeSeconds = 0;  // spent in the kernels
+    double stallSeconds = 0;    // kernels waiting for a block
+    const char* backend = "";   // reader backend
+    bool direct = false;        // O_DIRECT reads
+
+    double throughputMBps() const { return seconds > 0 ? bytesRead / seconds / 1e6 : 0; }
+};
+
+/**
+ * Packed matrix kept in a file and answered block by block: an
+ * AsyncFileReader keeps queueDepth blocks of rows in flight (at least two)
+ * while the kernels scan the block that arrived, reading straight from the
+ * reader's buffers. Only those blocks are ever in memory
+ */
+class DiskKernelMatrix {
+public:
+    /**
+     * Opens a file written by writeKernelMatrix. blockBytes is the size of
+     * each buffer (rounded to whole rows, and to whole pages with O_DIRECT).
+     * The queue depth and O_DIRECT come from asyncReadDefaults()
+     */
+    bool open(const std::string& path, uint64_t blockBytes = 64ULL << 20);
+
+    /**
+     * Shape of the matrix (words are not loaded)
+     */
+    const KernelMatrix& shape() const { return shape_; }
+    uint64_t blockRows() const { return blockRows_; }
+    uint64_t dataBytes() const { return shape_.rows * shape_.wordsPerRow * sizeof(uint64_t); }
+
+    /**
+     * Computes ans = D * ct, streaming D from the file
+     * Returns false (with a message) on a read error or a shape mismatch
+     */
+    bool answer(const PIRKernels& kernels, const Matrix& ct, Matrix& ans,
+                StreamStats* stats = nullptr, uint64_t numThreads = 0) const;
+
+    /**
+     * Writes back and drops the file's cached pages, so that the next scan
+     * reads from the disk. Returns the fraction of the file still cached
+     * afterwards (mincore), or -1 if it cannot be checked
+     */
+    double dropCache() const;
+
+    /**
+     * Read bandwidth of the file alone (same block size, no compute), in MB/s
+     */
+    double measureReadBandwidth() const;
+
+private:
+    AsyncReadOptions readOptions() const;
+
+    std::string path_;
+    KernelMatrix shape_;
+    uint64_t blockRows_ = 0;
+};
+
+/**
+ * Offline phase in memory, then writes the packed matrix to path, frees it
+ * and answers queryIndex by streaming the file. Reports the scan throughput
+ * against the file's read bandwidth. pir.db is filled with random values
+ * first if it was not loaded. Returns false on a wrong value
+ */
+bool runStreamingPIR(VLHEPIR& pir, uint64_t queryIndex, const std::string& path, uint64_t blockMiB = 64);
+
+#endif // STREAMING_PIR_H
@@ -0,0 +1,112 @@
+#ifndef TWO_SERVER_PIR_H
+#define TWO_SERVER_PIR_H
+
+#include "dpf.h"
+#include "util.h"
+#include "pir/database.h"
+#include "pir/pir.h"
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// Bit-sliced database
+// ============================================================================
+
+/**
+ * Database stored bit plane by bit plane: bit j of the entries 64w..64w+63
+ * is slices[w * d + j], so a selection vector is applied to all d planes
+ * of a word with d AND / XOR operations
+ */
+struct BitSlicedDatabase {
+    uint64_t N = 0;
+    uint64_t d = 0;
+    uint64_t numWords = 0;
+    std::vector<uint64_t> slices;
+
+    /**
+     * Transposes db (d <= 64)
+     */
+    static BitSlicedDatabase fromDatabase(const Database& db, uint64_t d);
+
+    /**
+     * XOR of the entries whose bit is set in selection (numWords words),
+     * split across threads
+     */
+    uint64_t answer(const std::vector<uint64_t>& selection, uint64_t numThreads = 0) const;
+};
+
+// ============================================================================
+// Two-server DPF PIR
+// ============================================================================
+
+/**
+ * Server-side timings of one answer
+ */
+struct DPFAnswerStats {
+    uint64_t evalMicros = 0;
+    uint64_t scanMicros = 0;
+};
+
+/**
+ * One server: expands its DPF key over the domain and XORs the selected
+ * entries. Holds the database, but never sees the queried index as long
+ * as the two servers do not collude
+ */
+class DPFPIRServer {
+public:
+    DPFPIRServer(const BitSlicedDatabase& db, uint64_t numThreads = 0) : db_(db), numThreads_(numThreads) {}
+
+    /**
+     * XOR of the entries selected by key. Returns false, before any
+     * evaluation, if the key is not one of the two parties' keys for
+     * this database's domain
+     */
+    bool Answer(const DPFKey& key, uint64_t& answer, DPFAnswerStats* stats = nullptr) const;
+
+private:
+    const BitSlicedDatabase& db_;
+    uint64_t numThreads_;
+};
+
+class DPFPIRClient {
+public:
+    /**
+     * Builds the keys for servers 0 and 1
+     */
+    static void Query(uint64_t N, uint64_t index, DPFKey& key0, DPFKey& key1);
+
+    static uint64_t Recover(uint64_t answer0, uint64_t answer1) { return answer0 ^ answer1; }
+};
+
+/**
+ * A DPFPIRServer running in a child process, reached over pipes
+ * (stands in for a remote, non-colluding server)
+ */
+class LocalServerProcess {
+public:
+    /**
+     * Forks a server over db (inherited by the child)
+     */
+    bool Start(const BitSlicedDatabase& db, uint64_t numThreads = 0);
+
+    /**
+     * Sends a serialized key, the answer is read with Receive
+     */
+    bool Send(const DPFKey& key);
+    bool Receive(uint64_t& answer, DPFAnswerStats& stats);
+
+    void Stop();
+
+private:
+    ChildProcess process_;
+};
+
+/**
+ * Runs the same query through two local DPF servers and through pir's
+ * single-server pipeline, and prints both timings. pir.db is filled with
+ * random values first if it was not loaded (random generation mode)
+ * Returns false if a recovered value does not match the database
+ */
+bool runTwoServerPIR(VLHEPIR& pir, uint64_t queryIndex, uint64_t numThreads = 0);
+
+#endif // TWO_SERVER_PIR_H
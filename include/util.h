@@ -0,0 +1,80 @@
+#ifndef UTIL_H
+#define UTIL_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <sys/types.h>
+
+// ============================================================================
+// Descriptors
+// ============================================================================
+
+/**
+ * Writes / reads exactly bytes bytes through a pipe or socket, retrying
+ * short transfers and EINTR. Returns false on error or end of stream
+ */
+bool writeAll(int fd, const void* data, uint64_t bytes);
+bool readAll(int fd, void* data, uint64_t bytes);
+
+/**
+ * Same at a file offset (pwrite / pread), the file position is unchanged
+ */
+bool writeAll(int fd, const void* data, uint64_t bytes, uint64_t offset);
+bool readAll(int fd, void* data, uint64_t bytes, uint64_t offset);
+
+// ============================================================================
+// Server processes
+// ============================================================================
+
+/**
+ * Forked child with a request and a response pipe. Every new child closes
+ * the parent's ends of the other running children, otherwise it would keep
+ * their request pipes open and they would never see EOF on Stop
+ */
+class ChildProcess {
+public:
+    ChildProcess() = default;
+    ~ChildProcess() { Stop(); }
+    ChildProcess(const ChildProcess&) = delete;
+    ChildProcess& operator=(const ChildProcess&) = delete;
+
+    /**
+     * Forks a child that runs serve(requestFd, responseFd) and exits when
+     * it returns. what names the child in error messages
+     */
+    bool Start(const std::string& what, const std::function<void(int, int)>& serve);
+
+    /**
+     * Parent ends: requests are written to toChild, replies read from fromChild
+     */
+    int toChild() const { return toChild_; }
+    int fromChild() const { return fromChild_; }
+
+    /**
+     * Closes the parent ends (EOF for the child) and waits for it
+     */
+    void Stop();
+
+private:
+    pid_t pid_ = -1;
+    int toChild_ = -1;
+    int fromChild_ = -1;
+};
+
+// ============================================================================
+// Reporting
+// ============================================================================
+
+/**
+ * Seconds elapsed since start
+ */
+double secondsSince(std::chrono::high_resolution_clock::time_point start);
+
+/**
+ * Size with a binary unit and one decimal ("512 B", "3.0 MiB")
+ */
+std::string formatBytes(uint64_t bytes);
+
+#endif // UTIL_H
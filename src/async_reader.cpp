@@ -0,0 +1,459 @@
+#include "async_reader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// io_uring through its system calls (no liburing needed), Linux only
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define PIR_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+AsyncReadOptions& asyncReadDefaults() {
+    static AsyncReadOptions options;
+    return options;
+}
+
+static uint64_t roundUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * Reads up to length bytes at offset, retrying partial reads
+ * Returns the bytes read (less than length at the end of the file) or -errno
+ */
+static int64_t preadFull(int fd, char* buffer, uint64_t length, uint64_t offset) {
+    uint64_t done = 0;
+    while (done < length) {
+        ssize_t n = pread(fd, buffer + done, length - done, offset + done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return -errno;
+        if (n == 0) break;
+        done += n;
+    }
+    return done;
+}
+
+// ============================================================================
+// Minimal io_uring
+// ============================================================================
+
+/**
+ * One submission / completion ring used from a single thread
+ */
+class IoUring {
+#ifdef PIR_IO_URING
+public:
+    ~IoUring() {
+        if (sqes_) munmap(sqes_, sqesBytes_);
+        if (cqRing_ && cqRing_ != sqRing_) munmap(cqRing_, cqRingBytes_);
+        if (sqRing_) munmap(sqRing_, sqRingBytes_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool init(unsigned entries) {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        fd_ = int(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0) return false;
+
+        sqRingBytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingBytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap) {
+            sqRingBytes_ = cqRingBytes_ = std::max(sqRingBytes_, cqRingBytes_);
+        }
+        sqRing_ = mapRing(sqRingBytes_, IORING_OFF_SQ_RING);
+        cqRing_ = singleMmap ? sqRing_ : mapRing(cqRingBytes_, IORING_OFF_CQ_RING);
+        sqesBytes_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(mapRing(sqesBytes_, IORING_OFF_SQES));
+        if (!sqRing_ || !cqRing_ || !sqes_) return false;
+
+        char* sq = static_cast<char*>(sqRing_);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        iovecs_.resize(params.sq_entries);
+        return true;
+    }
+
+    /**
+     * Pins the buffers once, so that reads skip the per-I/O page mapping
+     */
+    bool registerBuffers(const std::vector<iovec>& buffers) {
+        return syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS,
+                       buffers.data(), unsigned(buffers.size())) == 0;
+    }
+
+    /**
+     * Queues a read; fixedIndex >= 0 reads into registered buffer fixedIndex.
+     * slot (< entries) comes back as the completion's user data
+     */
+    void prepareRead(int fd, char* buffer, uint64_t length, uint64_t offset, int fixedIndex, uint64_t slot) {
+        unsigned tail = *sqTail_;
+        unsigned index = tail & *sqMask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->fd = fd;
+        sqe->off = offset;
+        if (fixedIndex >= 0) {
+            sqe->opcode = IORING_OP_READ_FIXED;
+            sqe->addr = reinterpret_cast<uint64_t>(buffer);
+            sqe->len = unsigned(length);
+            sqe->buf_index = uint16_t(fixedIndex);
+        } else {
+            iovecs_[slot].iov_base = buffer;
+            iovecs_[slot].iov_len = length;
+            sqe->opcode = IORING_OP_READV;
+            sqe->addr = reinterpret_cast<uint64_t>(&iovecs_[slot]);
+            sqe->len = 1;
+        }
+        sqe->user_data = slot;
+        sqArray_[index] = index;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        pending_++;
+    }
+
+    /**
+     * Submits the queued reads and waits for at least waitFor completions
+     */
+    bool enter(unsigned waitFor) {
+        while (true) {
+            long ret = syscall(__NR_io_uring_enter, fd_, pending_, waitFor,
+                               waitFor > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (ret < 0 && errno == EINTR) continue;
+            if (ret < 0) return false;
+            pending_ -= std::min<unsigned>(unsigned(ret), pending_);
+            return true;
+        }
+    }
+
+    bool popCompletion(uint64_t& slot, int64_t& result) {
+        unsigned head = *cqHead_;
+        if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) return false;
+        const io_uring_cqe& cqe = cqes_[head & *cqMask_];
+        slot = cqe.user_data;
+        result = cqe.res;
+        __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    void* mapRing(size_t bytes, off_t offset) {
+        void* ring = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        return ring == MAP_FAILED ? nullptr : ring;
+    }
+
+    int fd_ = -1;
+    unsigned pending_ = 0;
+    void* sqRing_ = nullptr;
+    void* cqRing_ = nullptr;
+    size_t sqRingBytes_ = 0, cqRingBytes_ = 0, sqesBytes_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned *sqTail_ = nullptr, *sqMask_ = nullptr, *sqArray_ = nullptr;
+    unsigned *cqHead_ = nullptr, *cqTail_ = nullptr, *cqMask_ = nullptr;
+    std::vector<iovec> iovecs_;
+#endif
+};
+
+// ============================================================================
+// AsyncFileReader
+// ============================================================================
+
+AsyncFileReader::AsyncFileReader() = default;
+
+AsyncFileReader::~AsyncFileReader() {
+    close();
+}
+
+const char* AsyncFileReader::backend() const {
+    if (ring_) return registered_ ? "io_uring (registered buffers)" : "io_uring";
+    return "pread";
+}
+
+bool AsyncFileReader::open(const std::string& path, const AsyncReadOptions& options, uint64_t offset, uint64_t length) {
+    close();
+    path_ = path;
+    options_ = options;
+    options_.queueDepth = std::max<uint64_t>(options_.queueDepth, 1);
+    options_.bufferBytes = std::max<uint64_t>(options_.bufferBytes, 1);
+
+#ifndef O_DIRECT
+    options_.direct = false;
+#endif
+    if (options_.direct && (offset % ASYNC_READ_ALIGNMENT != 0 || options_.bufferBytes % ASYNC_READ_ALIGNMENT != 0)) {
+        std::cerr << "Warning: O_DIRECT needs offsets and buffers aligned to " << ASYNC_READ_ALIGNMENT
+                  << " bytes, reading " << path << " through the page cache" << std::endl;
+        options_.direct = false;
+    }
+#ifdef O_DIRECT
+    fd_ = ::open(path.c_str(), O_RDONLY | (options_.direct ? O_DIRECT : 0));
+    if (fd_ < 0 && options_.direct && errno == EINVAL) {
+        std::cerr << "Warning: O_DIRECT not supported for " << path << ", reading through the page cache" << std::endl;
+        options_.direct = false;
+        fd_ = ::open(path.c_str(), O_RDONLY);
+    }
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY);
+#endif
+    if (fd_ < 0) {
+        std::cerr << "Error: unable to open file " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd_, &info) != 0 || uint64_t(info.st_size) < offset) {
+        std::cerr << "Error: " << path << " is shorter than " << offset << " bytes" << std::endl;
+        close();
+        return false;
+    }
+    const uint64_t available = uint64_t(info.st_size) - offset;
+    offset_ = offset;
+    length_ = (length == 0) ? available : std::min(length, available);
+    numChunks_ = (length_ + options_.bufferBytes - 1) / options_.bufferBytes;
+#ifdef POSIX_FADV_SEQUENTIAL
+    if (!options_.direct) {
+        posix_fadvise(fd_, offset_, length_, POSIX_FADV_SEQUENTIAL);
+    }
+#endif
+
+    // Buffer pool, aligned for O_DIRECT and registration
+    const uint64_t depth = options_.queueDepth;
+    const uint64_t slotBytes = roundUp(options_.bufferBytes, ASYNC_READ_ALIGNMENT);
+    if (posix_memalign(&pool_, ASYNC_READ_ALIGNMENT, slotBytes * depth) != 0) {
+        pool_ = nullptr;
+        std::cerr << "Error: unable to allocate " << depth << " read buffers of " << slotBytes << " bytes" << std::endl;
+        close();
+        return false;
+    }
+    slots_.resize(depth);
+    for (uint64_t i = 0; i < depth; i++) {
+        slots_[i].buffer = static_cast<char*>(pool_) + i * slotBytes;
+    }
+
+#ifdef PIR_IO_URING
+    if (options_.useIoUring) {
+        ring_.reset(new IoUring());
+        if (!ring_->init(unsigned(depth))) {
+            ring_.reset();
+        } else {
+            std::vector<iovec> buffers(depth);
+            for (uint64_t i = 0; i < depth; i++) {
+                buffers[i].iov_base = slots_[i].buffer;
+                buffers[i].iov_len = slotBytes;
+            }
+            registered_ = ring_->registerBuffers(buffers);
+        }
+    }
+#endif
+
+    if (!ring_) {
+        worker_ = std::thread(&AsyncFileReader::preadLoop, this);
+        return true;
+    }
+    for (uint64_t chunk = 0; chunk < std::min(depth, numChunks_); chunk++) {
+        submit(chunk);
+    }
+#ifdef PIR_IO_URING
+    if (!ring_->enter(0)) {
+        std::cerr << "Error: io_uring submission failed for " << path << ": " << strerror(errno) << std::endl;
+        failed_ = true;
+    }
+#endif
+    return !failed_;
+}
+
+uint64_t AsyncFileReader::chunkSize(uint64_t chunk) const {
+    return std::min(options_.bufferBytes, length_ - chunk * options_.bufferBytes);
+}
+
+uint64_t AsyncFileReader::requestSize(uint64_t chunk) const {
+    // O_DIRECT reads whole blocks (the last one may end past the range)
+    return options_.direct ? roundUp(chunkSize(chunk), ASYNC_READ_ALIGNMENT) : chunkSize(chunk);
+}
+
+void AsyncFileReader::submit(uint64_t chunk) {
+#ifdef PIR_IO_URING
+    const uint64_t index = chunk % slots_.size();
+    Slot& slot = slots_[index];
+    slot.chunk = chunk;
+    slot.state = SlotState::Reading;
+    ring_->prepareRead(fd_, slot.buffer, requestSize(chunk), offset_ + chunk * options_.bufferBytes,
+                       registered_ ? int(index) : -1, index);
+#endif
+}
+
+void AsyncFileReader::preadLoop() {
+    for (uint64_t chunk = 0; chunk < numChunks_; chunk++) {
+        Slot& slot = slots_[chunk % slots_.size()];
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&]() { return slot.state == SlotState::Free || stopping_; });
+            if (stopping_) return;
+            slot.chunk = chunk;
+            slot.state = SlotState::Reading;
+        }
+        int64_t result = preadFull(fd_, slot.buffer, requestSize(chunk), offset_ + chunk * options_.bufferBytes);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            slot.result = result;
+            slot.state = SlotState::Done;
+        }
+        cv_.notify_all();
+        if (result < 0) return;
+    }
+}
+
+bool AsyncFileReader::waitFor(Slot& slot) {
+    if (!ring_) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&]() { return slot.state == SlotState::Done; });
+        return true;
+    }
+#ifdef PIR_IO_URING
+    while (true) {
+        uint64_t index = 0;
+        int64_t result = 0;
+        while (ring_->popCompletion(index, result)) {
+            slots_[index].result = result;
+            slots_[index].state = SlotState::Done;
+        }
+        if (slot.state == SlotState::Done) return true;
+        if (!ring_->enter(1)) {
+            std::cerr << "Error: io_uring wait failed for " << path_ << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+    }
+#endif
+    return false;
+}
+
+bool AsyncFileReader::completeShortRead(Slot& slot) {
+    // Rare partial read before the end of the range: finish it synchronously
+    const uint64_t wanted = chunkSize(slot.chunk);
+    uint64_t done = uint64_t(slot.result);
+    int64_t result = preadFull(fd_, slot.buffer + done, requestSize(slot.chunk) - done,
+                               offset_ + slot.chunk * options_.bufferBytes + done);
+    if (result < 0 || done + uint64_t(result) < wanted) {
+        std::cerr << "Error: unexpected end of file in " << path_ << std::endl;
+        return false;
+    }
+    slot.result = done + result;
+    return true;
+}
+
+bool AsyncFileReader::next(const char*& data, uint64_t& size) {
+    release();
+    if (failed_ || nextChunk_ >= numChunks_) return false;
+
+    Slot& slot = slots_[nextChunk_ % slots_.size()];
+    if (!waitFor(slot)) {
+        failed_ = true;
+        return false;
+    }
+    if (slot.result < 0) {
+        std::cerr << "Error: read of " << path_ << " failed: " << strerror(int(-slot.result)) << std::endl;
+        failed_ = true;
+        return false;
+    }
+    const uint64_t wanted = chunkSize(nextChunk_);
+    if (uint64_t(slot.result) < wanted && !completeShortRead(slot)) {
+        failed_ = true;
+        return false;
+    }
+    data = slot.buffer;
+    size = wanted;
+    bytesRead_ += wanted;
+    holding_ = true;
+    nextChunk_++;
+    return true;
+}
+
+void AsyncFileReader::release() {
+    if (!holding_) return;
+    holding_ = false;
+    const uint64_t chunk = nextChunk_ - 1;
+    Slot& slot = slots_[chunk % slots_.size()];
+    if (!ring_) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            slot.state = SlotState::Free;
+        }
+        cv_.notify_all();
+        return;
+    }
+    slot.state = SlotState::Free;
+    const uint64_t following = chunk + slots_.size();
+    if (following < numChunks_) {
+        submit(following);
+#ifdef PIR_IO_URING
+        if (!ring_->enter(0)) {
+            std::cerr << "Error: io_uring submission failed for " << path_ << ": " << strerror(errno) << std::endl;
+            failed_ = true;
+        }
+#endif
+    }
+}
+
+void AsyncFileReader::close() {
+    holding_ = false;
+    if (ring_) {
+        // Buffers may only be freed once the kernel is done with them
+        for (Slot& slot : slots_) {
+            if (slot.state == SlotState::Reading && !waitFor(slot)) break;
+        }
+        ring_.reset();
+    }
+    if (worker_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        worker_.join();
+    }
+    free(pool_);
+    pool_ = nullptr;
+    slots_.clear();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    nextChunk_ = numChunks_ = bytesRead_ = 0;
+    failed_ = stopping_ = registered_ = false;
+}
+
+// ============================================================================
+// AsyncStreamBuf
+// ============================================================================
+
+AsyncStreamBuf::~AsyncStreamBuf() {
+    if (holding_) reader_.release();
+}
+
+AsyncStreamBuf::int_type AsyncStreamBuf::underflow() {
+    const char* data = nullptr;
+    uint64_t size = 0;
+    // next() gives the previous buffer back before waiting for the next one
+    holding_ = reader_.next(data, size);
+    if (!holding_ || size == 0) {
+        return traits_type::eof();
+    }
+    char* begin = const_cast<char*>(data);
+    setg(begin, begin, begin + size);
+    return traits_type::to_int_type(*begin);
+}
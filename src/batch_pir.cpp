@@ -0,0 +1,225 @@
+#include "batch_pir.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+
+// ============================================================================
+// Cuckoo-hashing batch code
+// ============================================================================
+
+BatchCode::BatchCode(uint64_t N, uint64_t k, uint64_t numHashes, uint64_t seed)
+    : N(N), numBuckets(std::max<uint64_t>((3 * k + 1) / 2, 1)), numHashes(numHashes), seed(seed) {
+    buckets.assign(numBuckets, {});
+    for (uint64_t index = 0; index < N; index++) {
+        for (uint64_t j = 0; j < numHashes; j++) {
+            uint64_t b = bucketOf(index, j);
+            // Candidates may coincide, store the index only once per bucket
+            if (buckets[b].empty() || buckets[b].back() != index) {
+                buckets[b].push_back(index);
+            }
+        }
+    }
+}
+
+uint64_t BatchCode::bucketOf(uint64_t index, uint64_t j) const {
+    return mix64(index ^ mix64(seed + j)) % numBuckets;
+}
+
+uint64_t BatchCode::positionIn(uint64_t bucket, uint64_t index) const {
+    const std::vector<uint64_t>& entries = buckets[bucket];
+    return std::lower_bound(entries.begin(), entries.end(), index) - entries.begin();
+}
+
+bool BatchCode::assign(const std::vector<uint64_t>& indices, std::vector<uint64_t>& assignment) const {
+    const uint64_t maxEvictions = 500;
+    std::mt19937_64 rng(seed);
+    assignment.assign(numBuckets, UINT64_MAX);
+
+    for (uint64_t index : indices) {
+        if (index >= N) {
+            std::cerr << "Error: index " << index << " out of bounds (max: " << (N - 1) << ")" << std::endl;
+            return false;
+        }
+        if (std::find(assignment.begin(), assignment.end(), index) != assignment.end()) {
+            continue;  // Duplicate index, already assigned
+        }
+
+        uint64_t current = index;
+        bool placed = false;
+        for (uint64_t step = 0; step < maxEvictions && !placed; step++) {
+            for (uint64_t j = 0; j < numHashes; j++) {
+                uint64_t b = bucketOf(current, j);
+                if (assignment[b] == UINT64_MAX) {
+                    assignment[b] = current;
+                    placed = true;
+                    break;
+                }
+            }
+            if (!placed) {
+                // Evict the occupant of a random candidate bucket
+                uint64_t b = bucketOf(current, rng() % numHashes);
+                std::swap(current, assignment[b]);
+            }
+        }
+        if (!placed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Batch PIR server
+// ============================================================================
+
+BatchPIRServer::BatchPIRServer(const Database& db, uint64_t d, const BatchCode& code, const PIRConfig& config)
+    : code(code) {
+    buckets.resize(code.numBuckets);
+    for (uint64_t b = 0; b < code.numBuckets; b++) {
+        const std::vector<uint64_t>& entries = code.buckets[b];
+        uint64_t n = std::max<uint64_t>(entries.size(), 1);
+
+        BatchBucket& bucket = buckets[b];
+        bucket.pir.reset(new VLHEPIR(n, d, config.allowTrivial, config.verbose, config.simplePIR,
+                                     false, config.batchSize, config.honestHint));
+        VLHEPIR& pir = *bucket.pir;
+
+        if (pir.db.alloc) {
+            free(pir.db.data);
+        }
+        pir.db.data = (entry_t*)malloc(pir.N * sizeof(entry_t));
+        pir.db.alloc = true;
+        for (uint64_t i = 0; i < pir.N; i++) {
+            pir.db.data[i] = (i < entries.size()) ? db.data[entries[i]] : entry_t(0);
+        }
+
+        Matrix D = pir.db.packDataInMatrix(pir.dbParams, false);
+        bucket.kernels = selectKernels(pir.dbParams);
+        bucket.D = bucket.kernels.pack(D);
+        bucket.A = pir.Init();
+        bucket.H = pir.GenerateHint(bucket.A, D);
+    }
+}
+
+std::vector<Matrix> BatchPIRServer::Answer(const std::vector<Matrix>& cts, uint64_t numThreads) const {
+    if (cts.size() != buckets.size()) {
+        std::cerr << "Error: expected " << buckets.size() << " bucket queries, got " << cts.size() << std::endl;
+        exit(1);
+    }
+
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numThreads = std::min<uint64_t>(numThreads, buckets.size());
+
+    // Buckets are similar in size: workers take them one at a time and
+    // answer each on a single thread
+    std::vector<Matrix> answers(buckets.size());
+    std::atomic<uint64_t> next(0);
+    auto worker = [&]() {
+        for (uint64_t b = next++; b < buckets.size(); b = next++) {
+            answers[b] = buckets[b].kernels.answer(buckets[b].D, cts[b], 1);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint64_t t = 0; t < numThreads; t++) {
+        workers.emplace_back(worker);
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    return answers;
+}
+
+double BatchPIRServer::scanOverhead() const {
+    // Each index is stored once per distinct candidate bucket
+    uint64_t stored = 0;
+    for (const auto& entries : code.buckets) {
+        stored += entries.size();
+    }
+    return (code.N == 0) ? 0.0 : double(stored) / double(code.N);
+}
+
+// ============================================================================
+// Batch PIR client
+// ============================================================================
+
+bool BatchPIRClient::Query(const BatchPIRServer& server, const std::vector<uint64_t>& indices) {
+    indices_ = indices;
+    if (!server.code.assign(indices, assignment_)) {
+        return false;
+    }
+
+    cts.assign(server.buckets.size(), Matrix());
+    sks_.assign(server.buckets.size(), Matrix());
+    for (uint64_t b = 0; b < server.buckets.size(); b++) {
+        uint64_t position = (assignment_[b] == UINT64_MAX) ? 0 : server.code.positionIn(b, assignment_[b]);
+        auto ct_sk = server.buckets[b].pir->Query(server.buckets[b].A, position);
+        cts[b] = std::get<0>(ct_sk);
+        sks_[b] = std::get<1>(ct_sk);
+    }
+    return true;
+}
+
+std::vector<entry_t> BatchPIRClient::Recover(const BatchPIRServer& server, const std::vector<Matrix>& answers) const {
+    std::vector<entry_t> results;
+    results.reserve(indices_.size());
+    for (uint64_t index : indices_) {
+        uint64_t b = std::find(assignment_.begin(), assignment_.end(), index) - assignment_.begin();
+        const BatchBucket& bucket = server.buckets[b];
+        results.push_back(bucket.pir->Recover(bucket.H, answers[b], sks_[b], server.code.positionIn(b, index)));
+    }
+    return results;
+}
+
+// ============================================================================
+// Batch pipeline
+// ============================================================================
+
+bool runBatchPIR(const Database& db, uint64_t d, const std::vector<uint64_t>& indices, const PIRConfig& config) {
+    std::cout << "=== Batch PIR ===" << std::endl;
+    std::cout << "Indices requested (k): " << indices.size() << std::endl;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    BatchCode code(db.N, indices.size());
+    BatchPIRServer server(db, d, code, config);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    std::cout << "Buckets: " << code.numBuckets << " (" << code.numHashes << " hash functions)" << std::endl;
+    std::cout << "Offline phase (all buckets): " << duration.count() << " ms" << std::endl;
+
+    BatchPIRClient client;
+    if (!client.Query(server, indices)) {
+        std::cerr << "Error: cuckoo assignment of the indices failed, retry with another seed" << std::endl;
+        return false;
+    }
+
+    // First execution (warmup, not measured)
+    std::vector<Matrix> answers = server.Answer(client.cts);
+
+    uint64_t iters = 10;
+    start_time = std::chrono::high_resolution_clock::now();
+    for (uint64_t i = 0; i < iters; i++) {
+        answers = server.Answer(client.cts);
+    }
+    end_time = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    std::cout << "Batch answer time (" << code.numBuckets << " sub-queries): " 
+              << duration.count() / double(iters) << " ms" << std::endl;
+    std::cout << "Server work: " << server.scanOverhead() << "x one full scan (vs " 
+              << indices.size() << "x for separate queries)" << std::endl;
+
+    std::vector<entry_t> results = client.Recover(server, answers);
+    bool ok = true;
+    for (uint64_t i = 0; i < indices.size(); i++) {
+        bool match = (results[i] == db.data[indices[i]]);
+        ok = ok && match;
+        std::cout << "  Index " << indices[i] << ": " << results[i].toUnsignedLong() 
+                  << (match ? " ✓" : " ✗") << std::endl;
+    }
+    return ok;
+}
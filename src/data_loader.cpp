@@ -1,14 +1,24 @@
 #include "data_loader.h"
+#include "async_reader.h"
 #include "pir/database.h"
 #include "pir/mat.h"
 #include "pir/mat_packed.h"
+#include "pir_kernels.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <cerrno>
 #include <cmath>
 #include <cstring>
+#include <memory>
+#include <random>
 #include <string>
+#include <vector>
+#include <unistd.h>
+
+// Number of parsed values handed to the specialized loader at once
+static const uint64_t LOAD_CHUNK_SIZE = 1ULL << 16;
 
 // Parquet support with Apache Arrow
 #ifdef PARQUET_SUPPORT
@@ -124,6 +134,119 @@ bool validateColumnForD(const std::string& csvFilePath,
     return true;
 }
 
+// ============================================================================
+// Single-pass column scan
+// ============================================================================
+
+/**
+ * Parses text[begin, end) as an unsigned integer. Surrounding blanks, an
+ * empty cell (0) and a zero fraction ("5.0") are accepted; a sign, another
+ * fraction ("5.5"), trailing characters or an overflow return false
+ */
+static bool parseUnsignedCell(const std::string& text, size_t begin, size_t end, uint64_t& value) {
+    size_t i = begin;
+    while (i < end && (text[i] == ' ' || text[i] == '\t')) i++;
+    
+    value = 0;
+    while (i < end && text[i] >= '0' && text[i] <= '9') {
+        uint64_t digit = static_cast<uint64_t>(text[i] - '0');
+        if (value > (UINT64_MAX - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+        i++;
+    }
+    if (i < end && text[i] == '.') {
+        i++;
+        while (i < end && text[i] == '0') i++;
+    }
+    
+    while (i < end && (text[i] == ' ' || text[i] == '\t' || text[i] == '\r' || text[i] == '\n')) i++;
+    return i == end;
+}
+
+/**
+ * Parses the first cell of a CSV line (see parseUnsignedCell)
+ */
+static bool parseFirstCell(const std::string& line, uint64_t& value) {
+    size_t comma = line.find(',');
+    return parseUnsignedCell(line, 0, (comma == std::string::npos) ? line.size() : comma, value);
+}
+
+/**
+ * Scans the remaining lines of a CSV stream
+ * D > 0: the maximum value check is a compile-time constant
+ * D = 0: maxValue is checked at runtime (UINT64_MAX disables the check)
+ */
+template <uint64_t D>
+static void scanCSVLines(std::istream& file, ColumnScan& scan, uint64_t maxValue) {
+    if constexpr (D > 0) {
+        maxValue = FixedLoader<D>::kMaxValue;
+    }
+    
+    std::string line;
+    uint64_t lineNumber = 0;
+    uint64_t value = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (line.find_first_not_of(" \t\r\n") == std::string::npos) continue;
+        
+        if (!parseFirstCell(line, value)) {
+            std::cerr << "Error: expected a non-negative integer (e.g. 5 or 5.0) at line " << lineNumber
+                      << ": " << line << std::endl;
+            return;
+        }
+        if (value > maxValue) {
+            std::cerr << "Error: value too large found at line " << lineNumber << ": " << value
+                      << " (max for d=" << scan.d << ": " << maxValue << ")" << std::endl;
+            return;
+        }
+        
+        scan.minValue = std::min(scan.minValue, value);
+        scan.maxValue = std::max(scan.maxValue, value);
+        scan.N++;
+    }
+    scan.valid = true;
+}
+
+ColumnScan scanCSVColumn(const std::string& csvFilePath,
+                         uint64_t d,
+                         bool hasHeader) {
+    ColumnScan scan;
+    scan.d = d;
+    
+    // Read ahead asynchronously, the parser reads the buffers in place
+    AsyncFileReader reader;
+    if (!reader.open(csvFilePath, asyncReadDefaults())) {
+        return scan;
+    }
+    AsyncStreamBuf buffer(reader);
+    std::istream file(&buffer);
+    
+    std::string line;
+    if (hasHeader && std::getline(file, line)) {
+        // Header line ignored
+    }
+    
+    switch (d) {
+#define PIR_SCAN_WIDTH(D_BITS) \
+        case D_BITS: scanCSVLines<D_BITS>(file, scan, 0); break;
+        PIR_DEPLOYED_WIDTHS(PIR_SCAN_WIDTH)
+#undef PIR_SCAN_WIDTH
+        default:
+            scanCSVLines<0>(file, scan, (d == 0 || d >= 64) ? UINT64_MAX : ((1ULL << d) - 1));
+            break;
+    }
+    
+    if (reader.failed()) {
+        scan.valid = false;
+    }
+    if (scan.valid && d == 0) {
+        scan.d = calculateBitSize(scan.maxValue);
+    }
+    return scan;
+}
+
 // ============================================================================
 // Database loading functions
 // ============================================================================
@@ -150,69 +273,62 @@ bool loadDatabaseFromCSV(Database& db,
     
     memset(db.data, 0, db.N * sizeof(entry_t));
     
-    std::ifstream file(csvFilePath);
-    if (!file.is_open()) {
-        std::cerr << "Error: unable to open file " << csvFilePath << std::endl;
+    AsyncFileReader reader;
+    if (!reader.open(csvFilePath, asyncReadDefaults())) {
         return false;
     }
+    AsyncStreamBuf buffer(reader);
+    std::istream file(&buffer);
     
     std::string line;
     uint64_t index = 0;
-    entry_t modulus = entry_t(1) << d;
-    entry_t maxValue = modulus - entry_t(1);
+    PIRKernels loader = selectKernels(d, 0);
+    std::vector<uint64_t> chunk;
+    chunk.reserve(LOAD_CHUNK_SIZE);
     
     // Skip header if present
     if (hasHeader && std::getline(file, line)) {
         // Header line ignored
     }
     
-    // Load data (first column only)
+    // Load data (first column only), values are stored chunk by chunk
+    // through the loader specialized on d
     while (std::getline(file, line) && index < db.N && (maxRows == 0 || index < maxRows)) {
-        if (line.empty()) continue;
+        if (line.find_first_not_of(" \t\r\n") == std::string::npos) continue;
         
         std::stringstream ss(line);
         std::string cell;
+        uint64_t value = 0;
         
         // Take the first column
         if (std::getline(ss, cell, ',') && !cell.empty()) {
-            try {
-                // Remove spaces
-                cell.erase(0, cell.find_first_not_of(" \t\r\n"));
-                cell.erase(cell.find_last_not_of(" \t\r\n") + 1);
-                
-                if (!cell.empty()) {
-                    uint64_t value = std::stoull(cell);
-                    entry_t entryValue = entry_t(static_cast<unsigned long>(value));
-                    
-                    if (entryValue > maxValue) {
-                        std::cerr << "Warning: value too large at line " 
-                                  << (index + 1) << ": " << cell 
-                                  << " (max for d=" << d << ": " << maxValue.toUnsignedLong() 
-                                  << ", used " << maxValue.toUnsignedLong() << ")" << std::endl;
-                        db.data[index] = maxValue;
-                    } else {
-                        db.data[index] = entryValue % modulus;
-                    }
-                } else {
-                    // Empty value, set to 0
-                    db.data[index] = entry_t(0);
+            // Remove spaces
+            cell.erase(0, cell.find_first_not_of(" \t\r\n"));
+            cell.erase(cell.find_last_not_of(" \t\r\n") + 1);
+            
+            if (!cell.empty()) {
+                try {
+                    value = std::stoull(cell);
+                } catch (const std::exception& e) {
+                    // If not a number, use 0
+                    std::cerr << "Warning: non-numeric value at line " 
+                              << (index + 1) << ": " << cell << " (used 0)" << std::endl;
                 }
-            } catch (const std::exception& e) {
-                // If not a number, use 0
-                std::cerr << "Warning: non-numeric value at line " 
-                          << (index + 1) << ": " << cell << " (used 0)" << std::endl;
-                db.data[index] = entry_t(0);
             }
-        } else {
-            // No column found, set to 0
-            db.data[index] = entry_t(0);
         }
         
+        chunk.push_back(value);
         index++;
+        if (chunk.size() == LOAD_CHUNK_SIZE) {
+            loader.load(db, index - chunk.size(), chunk.data(), chunk.size());
+            chunk.clear();
+        }
     }
+    loader.load(db, index - chunk.size(), chunk.data(), chunk.size());
     
-    file.close();
-    
+    if (reader.failed()) {
+        return false;
+    }
     if (index < db.N) {
         std::cerr << "Warning: only " << index 
                   << " lines loaded out of " << db.N << " expected" << std::endl;
@@ -237,18 +353,33 @@ VLHEPIR createVLHEPIRFromCSV(const std::string& csvFilePath,
                              bool simplePIR,
                              uint64_t batchSize,
                              bool honestHint) {
-    // 1. Count the number of lines
-    uint64_t N = countCSVLines(csvFilePath, hasHeader);
-    if (N == 0) {
-        std::cerr << "Error: no data found in CSV" << std::endl;
+    // Count the lines and verify the values in a single pass
+    // (d = 0: d is inferred from the column's maximum)
+    return createVLHEPIRFromCSV(csvFilePath, scanCSVColumn(csvFilePath, d, hasHeader), hasHeader,
+                                allowTrivial, verbose, simplePIR, batchSize, honestHint);
+}
+
+VLHEPIR createVLHEPIRFromCSV(const std::string& csvFilePath,
+                             const ColumnScan& scan,
+                             bool hasHeader,
+                             bool allowTrivial,
+                             bool verbose,
+                             bool simplePIR,
+                             uint64_t batchSize,
+                             bool honestHint) {
+    // 1. Lines counted and values verified by the scan
+    uint64_t d = scan.d;
+    if (!scan.valid) {
+        if (d > 0) {
+            entry_t maxValue = (entry_t(1) << d) - entry_t(1);
+            std::cerr << "Error: CSV must contain only values in [0, " 
+                      << maxValue.toUnsignedLong() << "] for d=" << d << std::endl;
+        }
         exit(1);
     }
-    
-    // 2. Verify that all values are valid for d bits
-    if (!validateColumnForD(csvFilePath, d, hasHeader)) {
-        entry_t maxValue = (entry_t(1) << d) - entry_t(1);
-        std::cerr << "Error: CSV must contain only values in [0, " 
-                  << maxValue.toUnsignedLong() << "] for d=" << d << std::endl;
+    uint64_t N = scan.N;
+    if (N == 0) {
+        std::cerr << "Error: no data found in CSV" << std::endl;
         exit(1);
     }
     
@@ -259,16 +390,16 @@ VLHEPIR createVLHEPIRFromCSV(const std::string& csvFilePath,
         std::cout << "  Database size: " << (N * d) / (8.0 * (1ULL << 20)) << " MiB" << std::endl;
     }
     
-    // 3. Create the database
+    // 2. Create the database
     Database db(N, d);
     
-    // 4. Load data from CSV
+    // 3. Load data from CSV
     if (!loadDatabaseFromCSV(db, csvFilePath, d, hasHeader)) {
         std::cerr << "Error: CSV loading failed" << std::endl;
         exit(1);
     }
     
-    // 5. Create the PIR
+    // 4. Create the PIR
     VLHEPIR pir(
         N, d,
         allowTrivial,
@@ -279,7 +410,7 @@ VLHEPIR createVLHEPIRFromCSV(const std::string& csvFilePath,
         honestHint
     );
     
-    // 6. Copy data into pir.db
+    // 5. Copy data into pir.db
     // Note: pir.db is already created in the constructor, we need to copy the data
     if (pir.db.alloc) {
         free(pir.db.data);
@@ -293,54 +424,143 @@ VLHEPIR createVLHEPIRFromCSV(const std::string& csvFilePath,
 /**
  * Prints statistics about a CSV file
  */
-void printCSVStats(const std::string& csvFilePath,
-                   uint64_t d,
-                   bool hasHeader) {
-    uint64_t N = countCSVLines(csvFilePath, hasHeader);
+void printCSVStats(const std::string& csvFilePath, const ColumnScan& scan) {
+    uint64_t d = scan.d;
+    uint64_t N = scan.N;
     entry_t maxValue = (entry_t(1) << d) - entry_t(1);
     
-    // Find min and max
-    uint64_t minVal = UINT64_MAX, maxVal = 0;
-    std::ifstream file(csvFilePath);
-    if (file.is_open()) {
-        std::string line;
-        if (hasHeader && std::getline(file, line)) {
-            // Skip header
-        }
-        while (std::getline(file, line)) {
-            if (line.empty()) continue;
-            std::stringstream ss(line);
-            std::string cell;
-            if (std::getline(ss, cell, ',')) {
-                cell.erase(0, cell.find_first_not_of(" \t\r\n"));
-                cell.erase(cell.find_last_not_of(" \t\r\n") + 1);
-                if (!cell.empty()) {
-                    try {
-                        uint64_t value = std::stoull(cell);
-                        if (value < minVal) minVal = value;
-                        if (value > maxVal) maxVal = value;
-                    } catch (...) {
-                        // Ignore
-                    }
-                }
-            }
-        }
-        file.close();
-    }
-    
     std::cout << "=== CSV Statistics ===" << std::endl;
     std::cout << "File: " << csvFilePath << std::endl;
     std::cout << "Number of lines (N): " << N << std::endl;
     std::cout << "Bit size (d): " << d << std::endl;
     std::cout << "Maximum allowed value: " << maxValue.toUnsignedLong() << std::endl;
-    if (minVal != UINT64_MAX) {
-        std::cout << "Minimum value found: " << minVal << std::endl;
-        std::cout << "Maximum value found: " << maxVal << std::endl;
+    if (scan.minValue != UINT64_MAX) {
+        std::cout << "Minimum value found: " << scan.minValue << std::endl;
+        std::cout << "Maximum value found: " << scan.maxValue << std::endl;
     }
     std::cout << "Database size: " << (N * d) / (8.0 * (1ULL << 20)) << " MiB" << std::endl;
     std::cout << "===============================" << std::endl;
 }
 
+// ============================================================================
+// Streaming ingest (stdin, pipes)
+// ============================================================================
+
+void ChunkedColumn::push(uint64_t value) {
+    if (chunks.empty() || chunks.back().size() == LOAD_CHUNK_SIZE) {
+        chunks.emplace_back();
+        chunks.back().reserve(LOAD_CHUNK_SIZE);
+    }
+    chunks.back().push_back(value);
+    maxValue = std::max(maxValue, value);
+    size++;
+}
+
+bool readCSVStream(ChunkedColumn& column, int fd, uint64_t d, bool hasHeader) {
+    const uint64_t maxValue = (d == 0 || d >= 64) ? UINT64_MAX : ((1ULL << d) - 1);
+    std::vector<char> buffer(asyncReadDefaults().bufferBytes);
+    std::string line;      // current line, carried over when a read ends inside it
+    uint64_t lineNumber = 0;
+    bool skipHeader = hasHeader;
+
+    // A line is handled when its newline arrives, the last one (possibly
+    // without a newline) at the end of the stream
+    auto handleLine = [&]() {
+        lineNumber++;
+        if (skipHeader) {
+            skipHeader = false;
+            return true;
+        }
+        if (line.find_first_not_of(" \t\r\n") == std::string::npos) return true;
+        uint64_t value = 0;
+        if (!parseFirstCell(line, value)) {
+            std::cerr << "Error: expected a non-negative integer (e.g. 5 or 5.0) at line " << lineNumber
+                      << ": " << line << std::endl;
+            return false;
+        }
+        if (value > maxValue) {
+            std::cerr << "Error: value too large found at line " << lineNumber << ": " << value
+                      << " (max for d=" << d << ": " << maxValue << ")" << std::endl;
+            return false;
+        }
+        column.push(value);
+        return true;
+    };
+
+    while (true) {
+        ssize_t bytes = read(fd, buffer.data(), buffer.size());
+        if (bytes < 0 && errno == EINTR) continue;
+        if (bytes < 0) {
+            std::cerr << "Error: unable to read the input stream: " << strerror(errno) << std::endl;
+            return false;
+        }
+        if (bytes == 0) break;
+        const char* begin = buffer.data();
+        const char* end = begin + bytes;
+        while (begin < end) {
+            const char* newline = static_cast<const char*>(memchr(begin, '\n', end - begin));
+            if (!newline) {
+                line.append(begin, end);
+                break;
+            }
+            line.append(begin, newline);
+            if (!handleLine()) return false;
+            line.clear();
+            begin = newline + 1;
+        }
+    }
+    return line.empty() || handleLine();
+}
+
+VLHEPIR createVLHEPIRFromStream(int fd,
+                                uint64_t d,
+                                bool hasHeader,
+                                bool allowTrivial,
+                                bool verbose,
+                                bool simplePIR,
+                                uint64_t batchSize,
+                                bool honestHint) {
+    // 1. Read the stream to its end, N is known only then
+    ChunkedColumn column;
+    if (!readCSVStream(column, fd, d, hasHeader)) {
+        exit(1);
+    }
+    uint64_t N = column.size;
+    if (N == 0) {
+        std::cerr << "Error: no data found in the input stream" << std::endl;
+        exit(1);
+    }
+    if (d == 0) {
+        d = calculateBitSize(column.maxValue);
+    }
+    std::cout << "Stream: " << N << " elements, d = " << d << " bits, "
+              << column.chunks.size() << " chunk(s)" << std::endl;
+
+    // 2. Create the PIR and copy the chunks into its entries
+    VLHEPIR pir(
+        N, d,
+        allowTrivial,
+        verbose,
+        simplePIR,
+        false,      // randomData = false (loading from the stream)
+        batchSize,
+        honestHint
+    );
+    if (!pir.db.alloc) {
+        pir.db.data = (entry_t*)malloc(N * sizeof(entry_t));
+        pir.db.alloc = true;
+    }
+    PIRKernels loader = selectKernels(d, 0);
+    uint64_t index = 0;
+    for (std::vector<uint64_t>& chunk : column.chunks) {
+        loader.load(pir.db, index, chunk.data(), chunk.size());
+        index += chunk.size();
+        // Freed once copied: the peak stays about one chunk above db.data
+        std::vector<uint64_t>().swap(chunk);
+    }
+    return pir;
+}
+
 // ============================================================================
 // Functions for Parquet files
 // ============================================================================
@@ -463,6 +683,112 @@ bool validateParquetColumnForD(const std::string& parquetFilePath,
     }
 }
 
+/**
+ * Scans the values of one Parquet chunk (same convention as scanCSVLines)
+ */
+template <uint64_t D>
+static bool scanParquetChunk(const std::shared_ptr<arrow::Array>& chunk, ColumnScan& scan, uint64_t maxValue) {
+    if constexpr (D > 0) {
+        maxValue = FixedLoader<D>::kMaxValue;
+    }
+    
+    auto visit = [&](uint64_t value) {
+        if (value > maxValue) {
+            std::cerr << "Error: invalid value found: " << value << std::endl;
+            return false;
+        }
+        scan.minValue = std::min(scan.minValue, value);
+        scan.maxValue = std::max(scan.maxValue, value);
+        return true;
+    };
+    
+    if (chunk->type_id() == arrow::Type::INT64) {
+        auto int64_array = std::static_pointer_cast<arrow::Int64Array>(chunk);
+        for (int64_t i = 0; i < int64_array->length(); i++) {
+            if (int64_array->IsNull(i)) continue;
+            int64_t value = int64_array->Value(i);
+            if (value < 0) {
+                std::cerr << "Error: invalid value found: " << value << std::endl;
+                return false;
+            }
+            if (!visit(static_cast<uint64_t>(value))) return false;
+        }
+    } else if (chunk->type_id() == arrow::Type::UINT64) {
+        auto uint64_array = std::static_pointer_cast<arrow::UInt64Array>(chunk);
+        for (int64_t i = 0; i < uint64_array->length(); i++) {
+            if (uint64_array->IsNull(i)) continue;
+            if (!visit(uint64_array->Value(i))) return false;
+        }
+    } else {
+        std::cerr << "Error: unsupported column type (must be INT64 or UINT64)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+ColumnScan scanParquetColumn(const std::string& parquetFilePath,
+                             uint64_t d,
+                             const std::string& columnName) {
+    ColumnScan scan;
+    scan.d = d;
+    try {
+        auto infile_result = arrow::io::ReadableFile::Open(parquetFilePath);
+        if (!infile_result.ok()) {
+            std::cerr << "Error: unable to open Parquet file " << parquetFilePath << std::endl;
+            return scan;
+        }
+        std::shared_ptr<arrow::io::ReadableFile> infile = infile_result.ValueOrDie();
+
+        auto reader_result = parquet::arrow::OpenFile(infile, arrow::default_memory_pool());
+        if (!reader_result.ok()) {
+            std::cerr << "Error: unable to read Parquet file" << std::endl;
+            return scan;
+        }
+        std::unique_ptr<parquet::arrow::FileReader> reader = std::move(reader_result.ValueOrDie());
+
+        std::shared_ptr<arrow::Table> table;
+        arrow::Status status = reader->ReadTable(&table);
+        if (!status.ok()) {
+            std::cerr << "Error: unable to read Parquet table" << std::endl;
+            return scan;
+        }
+
+        std::string colName = columnName.empty() ? table->schema()->field(0)->name() : columnName;
+        std::shared_ptr<arrow::ChunkedArray> column = table->GetColumnByName(colName);
+        if (!column) {
+            std::cerr << "Error: column '" << colName << "' not found" << std::endl;
+            return scan;
+        }
+
+        uint64_t maxValue = (d == 0 || d >= 64) ? UINT64_MAX : ((1ULL << d) - 1);
+        for (int chunk_idx = 0; chunk_idx < column->num_chunks(); chunk_idx++) {
+            bool ok = false;
+            switch (d) {
+#define PIR_SCAN_WIDTH(D_BITS) \
+                case D_BITS: ok = scanParquetChunk<D_BITS>(column->chunk(chunk_idx), scan, 0); break;
+                PIR_DEPLOYED_WIDTHS(PIR_SCAN_WIDTH)
+#undef PIR_SCAN_WIDTH
+                default:
+                    ok = scanParquetChunk<0>(column->chunk(chunk_idx), scan, maxValue);
+                    break;
+            }
+            if (!ok) {
+                return scan;
+            }
+        }
+
+        scan.N = table->num_rows();
+        scan.valid = true;
+        if (d == 0) {
+            scan.d = calculateBitSize(scan.maxValue);
+        }
+        return scan;
+    } catch (const std::exception& e) {
+        std::cerr << "Error during Parquet scan: " << e.what() << std::endl;
+        return scan;
+    }
+}
+
 bool loadDatabaseFromParquet(Database& db,
                             const std::string& parquetFilePath,
                             uint64_t d,
@@ -502,33 +828,34 @@ bool loadDatabaseFromParquet(Database& db,
             db.alloc = true;
         }
 
+        PIRKernels loader = selectKernels(d, 0);
+        std::vector<uint64_t> values;
+        values.reserve(LOAD_CHUNK_SIZE);
+        
         uint64_t idx = 0;
         for (int chunk_idx = 0; chunk_idx < column->num_chunks() && idx < N; chunk_idx++) {
             std::shared_ptr<arrow::Array> chunk = column->chunk(chunk_idx);
+            values.clear();
             
             if (chunk->type_id() == arrow::Type::INT64) {
                 auto int64_array = std::static_pointer_cast<arrow::Int64Array>(chunk);
-                for (int64_t i = 0; i < int64_array->length() && idx < N; i++) {
+                for (int64_t i = 0; i < int64_array->length() && idx + values.size() < N; i++) {
                     if (int64_array->IsNull(i)) {
-                        db.data[idx] = entry_t(0);
+                        values.push_back(0);
                     } else {
                         int64_t value = int64_array->Value(i);
-                        db.data[idx] = entry_t(static_cast<unsigned long>(std::max(0LL, value)));
+                        values.push_back(static_cast<uint64_t>(std::max<int64_t>(0, value)));
                     }
-                    idx++;
                 }
             } else if (chunk->type_id() == arrow::Type::UINT64) {
                 auto uint64_array = std::static_pointer_cast<arrow::UInt64Array>(chunk);
-                for (int64_t i = 0; i < uint64_array->length() && idx < N; i++) {
-                    if (uint64_array->IsNull(i)) {
-                        db.data[idx] = entry_t(0);
-                    } else {
-                        uint64_t value = uint64_array->Value(i);
-                        db.data[idx] = entry_t(static_cast<unsigned long>(value));
-                    }
-                    idx++;
+                for (int64_t i = 0; i < uint64_array->length() && idx + values.size() < N; i++) {
+                    values.push_back(uint64_array->IsNull(i) ? 0 : uint64_array->Value(i));
                 }
             }
+            
+            loader.load(db, idx, values.data(), values.size());
+            idx += values.size();
         }
 
         return true;
@@ -546,18 +873,21 @@ VLHEPIR createVLHEPIRFromParquet(const std::string& parquetFilePath,
                                 bool simplePIR,
                                 uint64_t batchSize,
                                 bool honestHint) {
-    uint64_t N = countParquetLines(parquetFilePath, columnName);
-    if (N == 0) {
-        std::cerr << "Error: no data found in Parquet file" << std::endl;
+    ColumnScan scan = scanParquetColumn(parquetFilePath, d, columnName);
+    if (!scan.valid) {
+        if (d > 0) {
+            entry_t maxValue = (entry_t(1) << d) - entry_t(1);
+            std::cerr << "Error: Parquet file must contain only values in [0, " 
+                      << maxValue.toUnsignedLong() << "] for d=" << d << std::endl;
+        }
         exit(1);
     }
-
-    if (!validateParquetColumnForD(parquetFilePath, d, columnName)) {
-        entry_t maxValue = (entry_t(1) << d) - entry_t(1);
-        std::cerr << "Error: Parquet file must contain only values in [0, " 
-                  << maxValue.toUnsignedLong() << "] for d=" << d << std::endl;
+    uint64_t N = scan.N;
+    if (N == 0) {
+        std::cerr << "Error: no data found in Parquet file" << std::endl;
         exit(1);
     }
+    d = scan.d;
 
     if (verbose) {
         std::cout << "Parquet Analysis:" << std::endl;
@@ -584,6 +914,109 @@ VLHEPIR createVLHEPIRFromParquet(const std::string& parquetFilePath,
     return pir;
 }
 
+bool readParquetKeyColumn(std::vector<std::string>& keys,
+                          const std::string& parquetFilePath,
+                          const std::string& keyColumn) {
+    try {
+        auto infile_result = arrow::io::ReadableFile::Open(parquetFilePath);
+        if (!infile_result.ok()) {
+            std::cerr << "Error: unable to open Parquet file" << std::endl;
+            return false;
+        }
+        std::shared_ptr<arrow::io::ReadableFile> infile = infile_result.ValueOrDie();
+
+        auto reader_result = parquet::arrow::OpenFile(infile, arrow::default_memory_pool());
+        if (!reader_result.ok()) {
+            return false;
+        }
+        std::unique_ptr<parquet::arrow::FileReader> reader = std::move(reader_result.ValueOrDie());
+
+        std::shared_ptr<arrow::Table> table;
+        arrow::Status status = reader->ReadTable(&table);
+        if (!status.ok()) {
+            return false;
+        }
+
+        std::shared_ptr<arrow::ChunkedArray> column = table->GetColumnByName(keyColumn);
+        if (!column) {
+            std::cerr << "Error: key column '" << keyColumn << "' not found" << std::endl;
+            return false;
+        }
+
+        keys.clear();
+        keys.reserve(table->num_rows());
+        for (int chunk_idx = 0; chunk_idx < column->num_chunks(); chunk_idx++) {
+            std::shared_ptr<arrow::Array> chunk = column->chunk(chunk_idx);
+            for (int64_t i = 0; i < chunk->length(); i++) {
+                auto scalar = chunk->GetScalar(i);
+                keys.push_back((chunk->IsNull(i) || !scalar.ok()) ? "" : scalar.ValueOrDie()->ToString());
+            }
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error reading Parquet key column: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool readParquetColumns(std::vector<std::vector<uint64_t>>& columns,
+                        const std::string& parquetFilePath,
+                        const std::vector<std::string>& names) {
+    try {
+        auto infile_result = arrow::io::ReadableFile::Open(parquetFilePath);
+        if (!infile_result.ok()) {
+            std::cerr << "Error: unable to open Parquet file" << std::endl;
+            return false;
+        }
+        std::shared_ptr<arrow::io::ReadableFile> infile = infile_result.ValueOrDie();
+
+        auto reader_result = parquet::arrow::OpenFile(infile, arrow::default_memory_pool());
+        if (!reader_result.ok()) {
+            return false;
+        }
+        std::unique_ptr<parquet::arrow::FileReader> reader = std::move(reader_result.ValueOrDie());
+
+        std::shared_ptr<arrow::Table> table;
+        arrow::Status status = reader->ReadTable(&table);
+        if (!status.ok()) {
+            return false;
+        }
+
+        columns.assign(names.size(), {});
+        for (uint64_t k = 0; k < names.size(); k++) {
+            std::shared_ptr<arrow::ChunkedArray> column = table->GetColumnByName(names[k]);
+            if (!column) {
+                std::cerr << "Error: column '" << names[k] << "' not found" << std::endl;
+                return false;
+            }
+            columns[k].reserve(table->num_rows());
+            for (int chunk_idx = 0; chunk_idx < column->num_chunks(); chunk_idx++) {
+                std::shared_ptr<arrow::Array> chunk = column->chunk(chunk_idx);
+                if (chunk->type_id() == arrow::Type::INT64) {
+                    auto int64_array = std::static_pointer_cast<arrow::Int64Array>(chunk);
+                    for (int64_t i = 0; i < int64_array->length(); i++) {
+                        int64_t value = int64_array->IsNull(i) ? 0 : int64_array->Value(i);
+                        columns[k].push_back(static_cast<uint64_t>(std::max<int64_t>(0, value)));
+                    }
+                } else if (chunk->type_id() == arrow::Type::UINT64) {
+                    auto uint64_array = std::static_pointer_cast<arrow::UInt64Array>(chunk);
+                    for (int64_t i = 0; i < uint64_array->length(); i++) {
+                        columns[k].push_back(uint64_array->IsNull(i) ? 0 : uint64_array->Value(i));
+                    }
+                } else {
+                    std::cerr << "Error: unsupported type for column " << names[k] 
+                              << " (must be INT64 or UINT64)" << std::endl;
+                    return false;
+                }
+            }
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error reading Parquet columns: " << e.what() << std::endl;
+        return false;
+    }
+}
+
 void printParquetStats(const std::string& parquetFilePath,
                       uint64_t d,
                       const std::string& columnName) {
@@ -615,7 +1048,6 @@ void printParquetStats(const std::string& parquetFilePath,
         }
 
         uint64_t N = table->num_rows();
-        entry_t maxValue = (entry_t(1) << d) - entry_t(1);
         uint64_t minVal = UINT64_MAX, maxVal = 0;
 
         for (int chunk_idx = 0; chunk_idx < column->num_chunks(); chunk_idx++) {
@@ -641,6 +1073,12 @@ void printParquetStats(const std::string& parquetFilePath,
             }
         }
 
+        // d = 0 reports the d inferred from the column's maximum
+        if (d == 0) {
+            d = calculateBitSize(maxVal);
+        }
+        entry_t maxValue = (entry_t(1) << d) - entry_t(1);
+
         std::cout << "=== Parquet Statistics ===" << std::endl;
         std::cout << "File: " << parquetFilePath << std::endl;
         std::cout << "Column: " << colName << std::endl;
@@ -671,6 +1109,11 @@ bool validateParquetColumnForD(const std::string&, uint64_t, const std::string&)
     return false;
 }
 
+ColumnScan scanParquetColumn(const std::string&, uint64_t, const std::string&) {
+    std::cerr << "Error: Parquet support not compiled" << std::endl;
+    return ColumnScan();
+}
+
 bool loadDatabaseFromParquet(Database&, const std::string&, uint64_t, const std::string&, uint64_t) {
     std::cerr << "Error: Parquet support not compiled" << std::endl;
     return false;
@@ -681,12 +1124,37 @@ VLHEPIR createVLHEPIRFromParquet(const std::string&, uint64_t, const std::string
     exit(1);
 }
 
+bool readParquetKeyColumn(std::vector<std::string>&, const std::string&, const std::string&) {
+    std::cerr << "Error: Parquet support not compiled" << std::endl;
+    return false;
+}
+
+bool readParquetColumns(std::vector<std::vector<uint64_t>>&, const std::string&, const std::vector<std::string>&) {
+    std::cerr << "Error: Parquet support not compiled" << std::endl;
+    return false;
+}
+
 void printParquetStats(const std::string&, uint64_t, const std::string&) {
     std::cerr << "Error: Parquet support not compiled" << std::endl;
 }
 
 #endif // PARQUET_SUPPORT
 
+ColumnScan scanColumn(const std::string& filePath,
+                      uint64_t d,
+                      const std::string& columnName,
+                      bool hasHeader) {
+    switch (detectFileFormat(filePath)) {
+        case FileFormat::CSV:
+            return scanCSVColumn(filePath, d, hasHeader);
+        case FileFormat::PARQUET:
+            return scanParquetColumn(filePath, d, columnName);
+        default:
+            std::cerr << "Error: unrecognized file format. Supported formats: .csv, .parquet" << std::endl;
+            return ColumnScan();
+    }
+}
+
 VLHEPIR createVLHEPIRFromFile(const std::string& filePath,
                               uint64_t d,
                               const std::string& columnName,
@@ -696,6 +1164,9 @@ VLHEPIR createVLHEPIRFromFile(const std::string& filePath,
                               bool simplePIR,
                               uint64_t batchSize,
                               bool honestHint) {
+    if (filePath == "-") {
+        return createVLHEPIRFromStream(STDIN_FILENO, d, hasHeader, allowTrivial, verbose, simplePIR, batchSize, honestHint);
+    }
     FileFormat format = detectFileFormat(filePath);
     
     switch (format) {
@@ -709,6 +1180,414 @@ VLHEPIR createVLHEPIRFromFile(const std::string& filePath,
     }
 }
 
+// ============================================================================
+// Locality-aware (grouped) layout
+// ============================================================================
+
+/**
+ * Returns the trimmed cell at position col of a CSV line ("" if missing)
+ */
+static std::string csvCell(const std::string& line, uint64_t col) {
+    size_t begin = 0;
+    for (uint64_t i = 0; i < col; i++) {
+        begin = line.find(',', begin);
+        if (begin == std::string::npos) return "";
+        begin++;
+    }
+    size_t end = line.find(',', begin);
+    std::string cell = line.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+    cell.erase(0, cell.find_first_not_of(" \t\r\n"));
+    cell.erase(cell.find_last_not_of(" \t\r\n") + 1);
+    return cell;
+}
+
+bool readCSVKeyColumn(std::vector<std::string>& keys,
+                      const std::string& csvFilePath,
+                      const std::string& keyColumn,
+                      bool hasHeader) {
+    std::ifstream file(csvFilePath);
+    if (!file.is_open()) {
+        std::cerr << "Error: unable to open file " << csvFilePath << std::endl;
+        return false;
+    }
+    
+    std::string line;
+    uint64_t col = UINT64_MAX;
+    if (hasHeader && std::getline(file, line)) {
+        uint64_t numColumns = std::count(line.begin(), line.end(), ',') + 1;
+        for (uint64_t i = 0; i < numColumns; i++) {
+            if (csvCell(line, i) == keyColumn) {
+                col = i;
+                break;
+            }
+        }
+    }
+    if (col == UINT64_MAX) {
+        if (keyColumn.empty() || keyColumn.find_first_not_of("0123456789") != std::string::npos) {
+            std::cerr << "Error: key column '" << keyColumn << "' not found" << std::endl;
+            return false;
+        }
+        col = std::stoull(keyColumn);
+    }
+    
+    keys.clear();
+    while (std::getline(file, line)) {
+        if (line.find_first_not_of(" \t\r\n") == std::string::npos) continue;
+        keys.push_back(csvCell(line, col));
+    }
+    return true;
+}
+
+bool readKeyColumn(std::vector<std::string>& keys,
+                   const std::string& filePath,
+                   const std::string& keyColumn,
+                   bool hasHeader) {
+    switch (detectFileFormat(filePath)) {
+        case FileFormat::CSV:
+            return readCSVKeyColumn(keys, filePath, keyColumn, hasHeader);
+        case FileFormat::PARQUET:
+            return readParquetKeyColumn(keys, filePath, keyColumn);
+        default:
+            std::cerr << "Error: unrecognized file format. Supported formats: .csv, .parquet" << std::endl;
+            return false;
+    }
+}
+
+std::unique_ptr<Database> loadRecordsWithKeys(const std::string& filePath,
+                                              uint64_t& d,
+                                              const std::string& keyColumn,
+                                              std::vector<std::string>& keys,
+                                              const std::string& columnName,
+                                              bool hasHeader) {
+    ColumnScan scan = scanColumn(filePath, d, columnName, hasHeader);
+    if (!scan.valid || scan.N == 0) {
+        std::cerr << "Error: no valid data found in " << filePath << std::endl;
+        return nullptr;
+    }
+    d = scan.d;
+    
+    std::unique_ptr<Database> records(new Database(scan.N, d));
+    bool loaded = (detectFileFormat(filePath) == FileFormat::PARQUET)
+        ? loadDatabaseFromParquet(*records, filePath, d, columnName)
+        : loadDatabaseFromCSV(*records, filePath, d, hasHeader);
+    if (!loaded) {
+        std::cerr << "Error: loading " << filePath << " failed" << std::endl;
+        return nullptr;
+    }
+    
+    if (!readKeyColumn(keys, filePath, keyColumn, hasHeader)) {
+        return nullptr;
+    }
+    if (keys.size() != scan.N) {
+        std::cerr << "Error: key column has " << keys.size() 
+                  << " rows, value column has " << scan.N << std::endl;
+        return nullptr;
+    }
+    return records;
+}
+
+VLHEPIR createGroupedVLHEPIRFromFile(const std::string& filePath,
+                                     uint64_t d,
+                                     const std::string& keyColumn,
+                                     IndexMap& map,
+                                     const std::string& columnName,
+                                     bool hasHeader,
+                                     bool allowTrivial,
+                                     bool verbose,
+                                     bool simplePIR,
+                                     uint64_t batchSize,
+                                     bool honestHint) {
+    // 1. Load the values and keys in record order
+    std::vector<std::string> keys;
+    std::unique_ptr<Database> records = loadRecordsWithKeys(filePath, d, keyColumn, keys, columnName, hasHeader);
+    if (!records) {
+        exit(1);
+    }
+    uint64_t N = records->N;
+    
+    // 2. Find a layout consistent with the parameters it induces: padding
+    //    changes N, which may change the column height chosen for the PIR.
+    //    Sizes are probed until the layout built for the column height of
+    //    a size fits in that size
+    uint64_t size = N;
+    bool stable = false;
+    const int maxAttempts = 8;
+    for (int attempt = 0; attempt < maxAttempts && !stable; attempt++) {
+        std::unique_ptr<VLHEPIR> probe(new VLHEPIR(size, d, allowTrivial, false, simplePIR, false, batchSize, honestHint));
+        map = buildGroupedLayout(keys, DBLayout::fromParams(probe->dbParams).entriesPerColumn);
+        stable = (map.paddedN <= size);
+        if (!stable) {
+            size = map.paddedN;
+        }
+    }
+    if (!stable) {
+        std::cerr << "Error: no stable grouped layout found after " << maxAttempts << " attempts" << std::endl;
+        exit(1);
+    }
+    VLHEPIR pir(size, d, allowTrivial, verbose, simplePIR, false, batchSize, honestHint);
+    
+    if (verbose) {
+        std::cout << "Grouped layout:" << std::endl;
+        std::cout << "  Records: " << N << std::endl;
+        std::cout << "  Entries per column: " << map.entriesPerColumn << std::endl;
+        std::cout << "  Positions (with padding): " << pir.N 
+                  << " (+" << 100.0 * (pir.N - N) / N << "%)" << std::endl;
+    }
+    
+    // 3. Scatter the records to their positions, padding stays 0
+    if (pir.db.alloc) {
+        free(pir.db.data);
+    }
+    pir.db.data = (entry_t*)malloc(pir.N * sizeof(entry_t));
+    pir.db.alloc = true;
+    for (uint64_t i = 0; i < pir.N; i++) {
+        pir.db.data[i] = entry_t(0);
+    }
+    for (uint64_t record = 0; record < N; record++) {
+        pir.db.data[map.positions[record]] = records->data[record];
+    }
+    
+    return pir;
+}
+
+// ============================================================================
+// Record mode (several columns per entry)
+// ============================================================================
+
+uint64_t RecordSchema::totalBits() const {
+    uint64_t bits = 0;
+    for (const auto& field : fields) {
+        bits += field.d;
+    }
+    return bits;
+}
+
+bool RecordSchema::parse(const std::string& spec, RecordSchema& schema) {
+    schema.fields.clear();
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        RecordField field;
+        size_t colon = item.find(':');
+        field.name = item.substr(0, colon);
+        if (colon != std::string::npos &&
+            (colon + 1 == item.size() || !parseUnsignedCell(item, colon + 1, item.size(), field.d))) {
+            std::cerr << "Error: invalid bit size in record field '" << item << "'" << std::endl;
+            return false;
+        }
+        if (field.name.empty()) {
+            std::cerr << "Error: empty record field name in '" << spec << "'" << std::endl;
+            return false;
+        }
+        schema.fields.push_back(field);
+    }
+    return !schema.fields.empty();
+}
+
+std::vector<uint64_t> RecordSchema::split(const entry_t& entry) const {
+    uint64_t packed = entry.toUnsignedLong();
+    std::vector<uint64_t> values;
+    for (const auto& field : fields) {
+        uint64_t mask = (field.d >= 64) ? UINT64_MAX : ((1ULL << field.d) - 1);
+        values.push_back((packed >> field.offset) & mask);
+    }
+    return values;
+}
+
+/**
+ * Resolves each column name to its position in the header, or reads it as
+ * a 0-based position
+ */
+static bool resolveCSVColumns(const std::string& header,
+                              const std::vector<std::string>& names,
+                              bool hasHeader,
+                              std::vector<uint64_t>& positions) {
+    positions.clear();
+    uint64_t numColumns = std::count(header.begin(), header.end(), ',') + 1;
+    for (const auto& name : names) {
+        uint64_t col = UINT64_MAX;
+        for (uint64_t i = 0; hasHeader && i < numColumns; i++) {
+            if (csvCell(header, i) == name) {
+                col = i;
+                break;
+            }
+        }
+        if (col == UINT64_MAX) {
+            if (name.find_first_not_of("0123456789") != std::string::npos) {
+                std::cerr << "Error: column '" << name << "' not found" << std::endl;
+                return false;
+            }
+            col = std::stoull(name);
+        }
+        positions.push_back(col);
+    }
+    return true;
+}
+
+/**
+ * Appends the selected cells of one CSV line to columns
+ */
+static bool parseCSVColumnsLine(const std::string& line,
+                                const std::vector<uint64_t>& positions,
+                                const std::vector<std::string>& names,
+                                uint64_t lineNumber,
+                                std::vector<std::vector<uint64_t>>& columns) {
+    if (line.find_first_not_of(" \t\r\n") == std::string::npos) return true;
+    for (uint64_t k = 0; k < positions.size(); k++) {
+        std::string cell = csvCell(line, positions[k]);
+        uint64_t value = 0;
+        if (!parseUnsignedCell(cell, 0, cell.size(), value)) {
+            std::cerr << "Error: expected a non-negative integer (e.g. 5 or 5.0) at line " << lineNumber
+                      << " (column " << names[k] << "): " << cell << std::endl;
+            return false;
+        }
+        columns[k].push_back(value);
+    }
+    return true;
+}
+
+bool readCSVColumns(std::vector<std::vector<uint64_t>>& columns,
+                    const std::string& csvFilePath,
+                    const std::vector<std::string>& names,
+                    bool hasHeader) {
+    std::ifstream file(csvFilePath);
+    if (!file.is_open()) {
+        std::cerr << "Error: unable to open file " << csvFilePath << std::endl;
+        return false;
+    }
+    
+    std::string line;
+    std::string header;
+    if (hasHeader) {
+        std::getline(file, header);
+    }
+    
+    std::vector<uint64_t> positions;
+    if (!resolveCSVColumns(header, names, hasHeader, positions)) {
+        return false;
+    }
+    
+    columns.assign(names.size(), {});
+    uint64_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (!parseCSVColumnsLine(line, positions, names, lineNumber, columns)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readCSVColumnsFrom(std::vector<std::vector<uint64_t>>& columns,
+                        const std::string& csvFilePath,
+                        const std::vector<std::string>& names,
+                        bool hasHeader,
+                        uint64_t& offset,
+                        uint64_t& lineNumber) {
+    std::ifstream file(csvFilePath, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: unable to open file " << csvFilePath << std::endl;
+        return false;
+    }
+    
+    std::string line;
+    std::string header;
+    if (hasHeader && (!std::getline(file, header) || file.eof())) {
+        columns.assign(names.size(), {});
+        return true;  // header not written yet
+    }
+    uint64_t dataStart = file.tellg();
+    std::vector<uint64_t> positions;
+    if (!resolveCSVColumns(header, names, hasHeader, positions)) {
+        return false;
+    }
+    
+    // Only lines already terminated by a newline: the writer may be in the
+    // middle of the last one
+    columns.assign(names.size(), {});
+    offset = std::max(offset, dataStart);
+    file.seekg(offset);
+    while (std::getline(file, line)) {
+        if (file.eof()) break;
+        offset += line.size() + 1;
+        lineNumber++;
+        if (!parseCSVColumnsLine(line, positions, names, lineNumber, columns)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+VLHEPIR createRecordVLHEPIRFromFile(const std::string& filePath,
+                                    RecordSchema& schema,
+                                    bool hasHeader,
+                                    bool allowTrivial,
+                                    bool verbose,
+                                    bool simplePIR,
+                                    uint64_t batchSize,
+                                    bool honestHint) {
+    // 1. Read all fields of every row
+    std::vector<std::string> names;
+    for (const auto& field : schema.fields) {
+        names.push_back(field.name);
+    }
+    std::vector<std::vector<uint64_t>> columns;
+    bool loaded = (detectFileFormat(filePath) == FileFormat::PARQUET)
+        ? readParquetColumns(columns, filePath, names)
+        : readCSVColumns(columns, filePath, names, hasHeader);
+    if (!loaded || columns.empty() || columns[0].empty()) {
+        std::cerr << "Error: no record data found in " << filePath << std::endl;
+        exit(1);
+    }
+    uint64_t N = columns[0].size();
+    
+    // 2. Resolve the widths and offsets of the fields
+    uint64_t offset = 0;
+    for (uint64_t k = 0; k < schema.fields.size(); k++) {
+        RecordField& field = schema.fields[k];
+        uint64_t maxValue = *std::max_element(columns[k].begin(), columns[k].end());
+        if (field.d == 0) {
+            field.d = calculateBitSize(maxValue);
+        } else if (field.d < 64 && maxValue > ((1ULL << field.d) - 1)) {
+            std::cerr << "Error: column " << field.name << " has value " << maxValue 
+                      << ", too large for d=" << field.d << std::endl;
+            exit(1);
+        }
+        field.offset = offset;
+        offset += field.d;
+    }
+    uint64_t d = schema.totalBits();
+    if (d > 64) {
+        std::cerr << "Error: record is " << d << " bits wide, at most 64 bits are supported" << std::endl;
+        exit(1);
+    }
+    
+    if (verbose) {
+        std::cout << "Record layout (" << d << " bits per entry):" << std::endl;
+        for (const auto& field : schema.fields) {
+            std::cout << "  " << field.name << ": bits [" << field.offset << ", " 
+                      << (field.offset + field.d) << ")" << std::endl;
+        }
+    }
+    
+    // 3. Concatenate the fields into one entry per row
+    VLHEPIR pir(N, d, allowTrivial, verbose, simplePIR, false, batchSize, honestHint);
+    if (pir.db.alloc) {
+        free(pir.db.data);
+    }
+    pir.db.data = (entry_t*)malloc(N * sizeof(entry_t));
+    pir.db.alloc = true;
+    for (uint64_t i = 0; i < N; i++) {
+        uint64_t packed = 0;
+        for (uint64_t k = 0; k < schema.fields.size(); k++) {
+            packed |= columns[k][i] << schema.fields[k].offset;
+        }
+        pir.db.data[i] = entry_t(static_cast<unsigned long>(packed));
+    }
+    
+    return pir;
+}
+
 // ============================================================================
 // Functions for generating random databases
 // ============================================================================
@@ -742,4 +1621,16 @@ VLHEPIR createVLHEPIRFromRandomData(uint64_t N,
     // The packed matrix will be created directly in main.cpp as in pir_bench.cpp
     
     return pir;
+}
+
+void fillRandomDatabase(Database& db, uint64_t d, uint64_t seed) {
+    if (!db.alloc) {
+        db.data = (entry_t*)malloc(db.N * sizeof(entry_t));
+        db.alloc = true;
+    }
+    std::mt19937_64 rng(seed);
+    uint64_t mask = (d >= 64) ? UINT64_MAX : ((1ULL << d) - 1);
+    for (uint64_t i = 0; i < db.N; i++) {
+        db.data[i] = entry_t(static_cast<unsigned long>(rng() & mask));
+    }
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "db_layout.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+// ============================================================================
+// Database matrix layout
+// ============================================================================
+
+DBLayout DBLayout::fromParams(const DBParams& params) {
+    return make(params.N, params.d, params.ell, params.m, params.p);
+}
+
+DBLayout DBLayout::make(uint64_t N, uint64_t d, uint64_t ell, uint64_t m, uint64_t p) {
+    DBLayout layout;
+    layout.N = N;
+    layout.d = d;
+    layout.ell = ell;
+    layout.m = m;
+    layout.p = p;
+
+    uint64_t bits = 0;
+    while (bits < 63 && (2ULL << bits) <= p) {
+        bits++;
+    }
+    layout.bitsPerElem = std::max<uint64_t>(bits, 1);
+
+    if (d <= layout.bitsPerElem) {
+        layout.entriesPerElem = layout.bitsPerElem / d;
+        layout.elemsPerEntry = 1;
+    } else {
+        layout.entriesPerElem = 1;
+        layout.elemsPerEntry = (d + layout.bitsPerElem - 1) / layout.bitsPerElem;
+    }
+    layout.entriesPerColumn = std::max<uint64_t>((ell / layout.elemsPerEntry) * layout.entriesPerElem, 1);
+    return layout;
+}
+
+// ============================================================================
+// Locality-aware (grouped) index layout
+// ============================================================================
+
+IndexMap buildGroupedLayout(const std::vector<std::string>& keys, uint64_t entriesPerColumn) {
+    IndexMap map;
+    map.entriesPerColumn = std::max<uint64_t>(entriesPerColumn, 1);
+    map.keys = keys;
+    map.positions.assign(keys.size(), 0);
+
+    // Group records by key, in order of first appearance
+    std::unordered_map<std::string, uint64_t> groupOf;
+    std::vector<std::vector<uint64_t>> groups;
+    for (uint64_t record = 0; record < keys.size(); record++) {
+        auto it = groupOf.find(keys[record]);
+        if (it == groupOf.end()) {
+            it = groupOf.emplace(keys[record], groups.size()).first;
+            groups.emplace_back();
+        }
+        groups[it->second].push_back(record);
+    }
+
+    const uint64_t E = map.entriesPerColumn;
+    uint64_t cursor = 0;
+    for (const auto& group : groups) {
+        uint64_t used = cursor % E;
+        if (used != 0 && group.size() > E - used) {
+            cursor += E - used;
+        }
+        for (uint64_t record : group) {
+            map.positions[record] = cursor++;
+        }
+    }
+    map.paddedN = cursor;
+    return map;
+}
+
+bool saveIndexMap(const IndexMap& map, const std::string& path) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: unable to write index map " << path << std::endl;
+        return false;
+    }
+
+    file << "# entriesPerColumn=" << map.entriesPerColumn << " paddedN=" << map.paddedN << "\n";
+    file << "record,position,group\n";
+    for (uint64_t record = 0; record < map.positions.size(); record++) {
+        file << record << "," << map.positions[record] << "," << map.keys[record] << "\n";
+    }
+    return file.good();
+}
+
+bool loadIndexMap(IndexMap& map, const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: unable to open index map " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) ||
+        sscanf(line.c_str(), "# entriesPerColumn=%" SCNu64 " paddedN=%" SCNu64,
+               &map.entriesPerColumn, &map.paddedN) != 2) {
+        std::cerr << "Error: invalid index map header in " << path << std::endl;
+        return false;
+    }
+    std::getline(file, line);  // Column names
+
+    map.positions.clear();
+    map.keys.clear();
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        size_t first = line.find(',');
+        size_t second = (first == std::string::npos) ? first : line.find(',', first + 1);
+        if (second == std::string::npos) {
+            std::cerr << "Error: invalid index map line: " << line << std::endl;
+            return false;
+        }
+        uint64_t record = std::stoull(line.substr(0, first));
+        if (record != map.positions.size()) {
+            std::cerr << "Error: index map records must be in order (line: " << line << ")" << std::endl;
+            return false;
+        }
+        map.positions.push_back(std::stoull(line.substr(first + 1, second - first - 1)));
+        map.keys.push_back(line.substr(second + 1));
+    }
+    return true;
+}
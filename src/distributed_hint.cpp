@@ -0,0 +1,234 @@
+#include "distributed_hint.h"
+#include "util.h"
+#include <openssl/rand.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+/**
+ * Sent by a worker ahead of its block: the rows it covers, its compute
+ * time, then the SHA-256 of the block
+ */
+struct HintBlockHeader {
+    uint64_t firstRow;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t micros;
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+};
+
+// ============================================================================
+// Product check
+// ============================================================================
+
+bool checkHintProduct(const PIRKernels& kernels, const KernelMatrix& D, const Matrix& A,
+                      const Matrix& H, uint64_t k) {
+    if (H.rows != D.rows || H.cols != A.cols || A.rows != D.cols) {
+        std::cerr << "Error: hint is " << H.rows << " x " << H.cols << ", expected "
+                  << D.rows << " x " << A.cols << std::endl;
+        return false;
+    }
+    const uint64_t n = A.cols;
+    std::vector<Elem> R(n * k);
+    RAND_bytes(reinterpret_cast<uint8_t*>(R.data()), R.size() * sizeof(Elem));
+
+    // D * (A * R) with the answer kernel, A * R as a k-column batch query
+    Matrix AR(A.rows, k);
+    std::vector<Elem> sums(k);
+    for (uint64_t i = 0; i < A.rows; i++) {
+        std::fill(sums.begin(), sums.end(), 0);
+        for (uint64_t c = 0; c < n; c++) {
+            Elem a = A.data[i * n + c];
+            for (uint64_t j = 0; j < k; j++) {
+                sums[j] += a * R[c * k + j];
+            }
+        }
+        std::copy(sums.begin(), sums.end(), AR.data + i * k);
+    }
+    Matrix DAR = kernels.answer(D, AR);
+
+    for (uint64_t r = 0; r < H.rows; r++) {
+        std::fill(sums.begin(), sums.end(), 0);
+        for (uint64_t c = 0; c < n; c++) {
+            Elem h = H.data[r * n + c];
+            for (uint64_t j = 0; j < k; j++) {
+                sums[j] += h * R[c * k + j];
+            }
+        }
+        if (!std::equal(sums.begin(), sums.end(), DAR.data + r * k)) {
+            std::cerr << "Error: hint row " << r << " is not row " << r << " of D * A" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Workers
+// ============================================================================
+
+/**
+ * Worker body: computes its block and writes it to fd, then exits
+ */
+[[noreturn]] static void runHintWorker(int fd, const PIRKernels& kernels, const KernelMatrix& D,
+                                       const std::vector<Elem>& padded, uint64_t n,
+                                       uint64_t firstRow, uint64_t rows, uint64_t threads) {
+    KernelMatrix block;
+    block.rows = rows;
+    block.cols = D.cols;
+    block.logp = D.logp;
+    block.digitsPerWord = D.digitsPerWord;
+    block.wordsPerRow = D.wordsPerRow;
+    block.external = D.data() + firstRow * D.wordsPerRow;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<Elem> out(rows * n);
+    kernels.hintBlock(out.data(), block, padded.data(), n, threads);
+
+    HintBlockHeader header;
+    header.firstRow = firstRow;
+    header.rows = rows;
+    header.cols = n;
+    header.micros = uint64_t(secondsSince(start_time) * 1e6);
+    SHA256(reinterpret_cast<const unsigned char*>(out.data()), out.size() * sizeof(Elem), header.digest);
+    bool ok = writeAll(fd, &header, sizeof(header)) && writeAll(fd, out.data(), out.size() * sizeof(Elem));
+    close(fd);
+    _exit(ok ? 0 : 1);
+}
+
+/**
+ * Reads one worker's block into its rows of H and checks its digest
+ */
+static bool receiveHintBlock(HintWorker& worker, Matrix& H) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    HintBlockHeader header;
+    if (!readAll(worker.fromWorker, &header, sizeof(header))) {
+        std::cerr << "Error: hint worker " << worker.pid << " exited before sending its block" << std::endl;
+        return false;
+    }
+    if (header.firstRow != worker.firstRow || header.rows != worker.rows || header.cols != H.cols) {
+        std::cerr << "Error: hint worker " << worker.pid << " sent rows " << header.firstRow << "+"
+                  << header.rows << ", expected " << worker.firstRow << "+" << worker.rows << std::endl;
+        return false;
+    }
+    Elem* block = H.data + worker.firstRow * H.cols;
+    const uint64_t bytes = worker.rows * H.cols * sizeof(Elem);
+    if (!readAll(worker.fromWorker, block, bytes)) {
+        std::cerr << "Error: hint worker " << worker.pid << " sent a truncated block" << std::endl;
+        return false;
+    }
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char*>(block), bytes, digest);
+    if (memcmp(digest, header.digest, SHA256_DIGEST_LENGTH) != 0) {
+        std::cerr << "Error: block of hint worker " << worker.pid << " does not match its digest" << std::endl;
+        return false;
+    }
+    worker.seconds = header.micros / 1e6;
+    worker.receiveSeconds = secondsSince(start_time);
+    return true;
+}
+
+// ============================================================================
+// Coordinator
+// ============================================================================
+
+bool generateHintDistributed(VLHEPIR& pir, const PIRKernels& kernels, const KernelMatrix& D,
+                             const Matrix& A, uint64_t numWorkers, uint64_t threadsPerWorker,
+                             Matrix& H, unsigned char digest[SHA256_DIGEST_LENGTH]) {
+    if (A.rows != D.cols) {
+        std::cerr << "Error: A has " << A.rows << " rows, database has " << D.cols << " columns" << std::endl;
+        return false;
+    }
+    numWorkers = std::min<uint64_t>(std::max<uint64_t>(numWorkers, 1), std::max<uint64_t>(D.rows, 1));
+    if (threadsPerWorker == 0) {
+        threadsPerWorker = std::max<uint64_t>(std::thread::hardware_concurrency() / numWorkers, 1);
+    }
+
+    const uint64_t n = A.cols;
+    std::vector<Elem> padded = padQuery(A, D.wordsPerRow * D.digitsPerWord);
+    H = Matrix(D.rows, n);
+
+    // Contiguous row blocks, as even as possible
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<HintWorker> workers(numWorkers);
+    bool ok = true;
+    for (uint64_t w = 0; w < numWorkers && ok; w++) {
+        HintWorker& worker = workers[w];
+        worker.firstRow = D.rows * w / numWorkers;
+        worker.rows = D.rows * (w + 1) / numWorkers - worker.firstRow;
+        int fds[2];
+        if (pipe(fds) != 0) {
+            std::cerr << "Error: unable to create a pipe for hint worker " << w << std::endl;
+            ok = false;
+            break;
+        }
+        std::cout.flush();
+        worker.pid = fork();
+        if (worker.pid < 0) {
+            std::cerr << "Error: unable to start hint worker " << w << std::endl;
+            close(fds[0]);
+            close(fds[1]);
+            ok = false;
+            break;
+        }
+        if (worker.pid == 0) {
+            close(fds[0]);
+            for (uint64_t other = 0; other < w; other++) {
+                close(workers[other].fromWorker);
+            }
+            runHintWorker(fds[1], kernels, D, padded, n, worker.firstRow, worker.rows, threadsPerWorker);
+        }
+        close(fds[1]);
+        worker.fromWorker = fds[0];
+    }
+
+    // Every block is read in full before the next one, the other workers
+    // wait on their pipe meanwhile
+    for (HintWorker& worker : workers) {
+        if (worker.pid <= 0) continue;
+        worker.ok = ok && receiveHintBlock(worker, H);
+        ok = ok && worker.ok;
+        close(worker.fromWorker);
+        int status = 0;
+        waitpid(worker.pid, &status, 0);
+        if (worker.ok && (!WIFEXITED(status) || WEXITSTATUS(status) != 0)) {
+            std::cerr << "Error: hint worker " << worker.pid << " failed" << std::endl;
+            ok = false;
+        }
+    }
+    if (!ok) {
+        return false;
+    }
+    double totalSeconds = secondsSince(start_time);
+
+    std::cout << "Hint H generated by " << numWorkers << " workers (" << threadsPerWorker
+              << " threads each) in " << totalSeconds * 1000 << " ms" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (uint64_t w = 0; w < numWorkers; w++) {
+        const HintWorker& worker = workers[w];
+        std::cout << "  worker " << w << ": rows " << worker.firstRow << "-" << worker.firstRow + worker.rows
+                  << ", compute " << worker.seconds * 1000 << " ms, transfer "
+                  << worker.receiveSeconds * 1000 << " ms" << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+
+    // The stitched hint must be D * A before it is committed to in the proofs
+    start_time = std::chrono::high_resolution_clock::now();
+    if (!checkHintProduct(kernels, D, A, H)) {
+        return false;
+    }
+    pir.HashAandH(digest, A, H);
+    std::cout << "Stitched hint checked in " << secondsSince(start_time) * 1000 << " ms, HashAandH digest ";
+    std::cout << std::hex << std::setfill('0');
+    for (uint64_t i = 0; i < 8; i++) {
+        std::cout << std::setw(2) << int(digest[i]);
+    }
+    std::cout << std::dec << std::setfill(' ') << "..." << std::endl;
+    return true;
+}
@@ -0,0 +1,295 @@
+#include "dpf.h"
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// ============================================================================
+// AES-based PRG
+// ============================================================================
+
+/**
+ * Fixed public AES keys: G(s) = (AES_kL(s) ^ s, AES_kR(s) ^ s) and the leaf
+ * conversion AES_kC(s) ^ s (Matyas-Meyer-Oseas with fixed keys)
+ */
+static const uint8_t kLeftKey[16] = {0x3a, 0x91, 0x5c, 0x0e, 0x77, 0xd2, 0x48, 0xb6,
+                                     0x1f, 0xe4, 0x62, 0x9d, 0x05, 0xc8, 0xab, 0x30};
+static const uint8_t kRightKey[16] = {0x8e, 0x27, 0xf1, 0x4b, 0x93, 0x6a, 0x0d, 0xc5,
+                                      0x52, 0xb8, 0x1e, 0x79, 0xe6, 0x34, 0xa0, 0x0b};
+static const uint8_t kConvertKey[16] = {0xd4, 0x5f, 0x08, 0xa3, 0x6c, 0x19, 0xbe, 0x72,
+                                        0xc1, 0x2d, 0x96, 0x4e, 0x3b, 0xf0, 0x87, 0x65};
+
+/**
+ * One set of AES contexts (not thread-safe, one per thread)
+ */
+class DPFPrg {
+public:
+    DPFPrg() {
+        initContext(left_, kLeftKey);
+        initContext(right_, kRightKey);
+        initContext(convert_, kConvertKey);
+    }
+    ~DPFPrg() {
+        EVP_CIPHER_CTX_free(left_);
+        EVP_CIPHER_CTX_free(right_);
+        EVP_CIPHER_CTX_free(convert_);
+    }
+    DPFPrg(const DPFPrg&) = delete;
+    DPFPrg& operator=(const DPFPrg&) = delete;
+
+    /**
+     * outLeft[i] = AES_kL(in[i]) ^ in[i], outRight[i] = AES_kR(in[i]) ^ in[i]
+     */
+    void expand(const DPFBlock* in, DPFBlock* outLeft, DPFBlock* outRight, uint64_t count) {
+        encrypt(left_, in, outLeft, count);
+        encrypt(right_, in, outRight, count);
+        for (uint64_t i = 0; i < count; i++) {
+            outLeft[i] ^= in[i];
+            outRight[i] ^= in[i];
+        }
+    }
+
+    /**
+     * out[i] = AES_kC(in[i]) ^ in[i]
+     */
+    void convert(const DPFBlock* in, DPFBlock* out, uint64_t count) {
+        encrypt(convert_, in, out, count);
+        for (uint64_t i = 0; i < count; i++) {
+            out[i] ^= in[i];
+        }
+    }
+
+private:
+    EVP_CIPHER_CTX* left_ = nullptr;
+    EVP_CIPHER_CTX* right_ = nullptr;
+    EVP_CIPHER_CTX* convert_ = nullptr;
+
+    static void initContext(EVP_CIPHER_CTX*& ctx, const uint8_t* key) {
+        ctx = EVP_CIPHER_CTX_new();
+        EVP_EncryptInit_ex(ctx, EVP_aes_128_ecb(), nullptr, key, nullptr);
+        EVP_CIPHER_CTX_set_padding(ctx, 0);
+    }
+
+    static void encrypt(EVP_CIPHER_CTX* ctx, const DPFBlock* in, DPFBlock* out, uint64_t count) {
+        // ECB over the whole array: one call per level, pipelined by AES-NI
+        const uint64_t maxBlocks = 1ULL << 26;  // keeps the length within int
+        for (uint64_t done = 0; done < count; done += maxBlocks) {
+            int len = 0;
+            int blocks = static_cast<int>(std::min(maxBlocks, count - done));
+            EVP_EncryptUpdate(ctx, reinterpret_cast<uint8_t*>(out + done), &len,
+                              reinterpret_cast<const uint8_t*>(in + done), blocks * 16);
+        }
+    }
+};
+
+/**
+ * The control bit is the low bit of the PRG output, the seed is the rest
+ */
+static inline uint8_t takeControlBit(DPFBlock& block) {
+    uint8_t t = block.lo & 1;
+    block.lo &= ~1ULL;
+    return t;
+}
+
+// ============================================================================
+// Key generation
+// ============================================================================
+
+uint32_t dpfDepthForDomain(uint64_t N) {
+    uint32_t bits = 0;
+    while (bits < 64 && (1ULL << bits) < N) {
+        bits++;
+    }
+    return (bits > DPF_LEAF_BITS) ? bits - DPF_LEAF_BITS : 0;
+}
+
+void dpfGen(uint64_t alpha, uint32_t depth, DPFKey& key0, DPFKey& key1) {
+    DPFPrg prg;
+    DPFBlock s[2];
+    RAND_bytes(reinterpret_cast<uint8_t*>(s), sizeof(s));
+    takeControlBit(s[0]);
+    takeControlBit(s[1]);
+    uint8_t t[2] = {0, 1};
+
+    key0 = DPFKey();
+    key1 = DPFKey();
+    key0.party = 0;
+    key1.party = 1;
+    key0.depth = key1.depth = depth;
+    key0.seed = s[0];
+    key1.seed = s[1];
+
+    uint64_t path = alpha >> DPF_LEAF_BITS;
+    for (uint32_t level = 0; level < depth; level++) {
+        uint8_t bit = (path >> (depth - 1 - level)) & 1;
+
+        DPFBlock left[2], right[2];
+        uint8_t tLeft[2], tRight[2];
+        prg.expand(s, left, right, 2);
+        for (int b = 0; b < 2; b++) {
+            tLeft[b] = takeControlBit(left[b]);
+            tRight[b] = takeControlBit(right[b]);
+        }
+
+        // Correct the "lose" side to equal seeds, the "keep" side to
+        // differing control bits
+        DPFBlock seedCW = bit ? (left[0] ^ left[1]) : (right[0] ^ right[1]);
+        uint8_t tLeftCW = tLeft[0] ^ tLeft[1] ^ bit ^ 1;
+        uint8_t tRightCW = tRight[0] ^ tRight[1] ^ bit;
+        key0.seedCW.push_back(seedCW);
+        key0.tLeftCW.push_back(tLeftCW);
+        key0.tRightCW.push_back(tRightCW);
+
+        for (int b = 0; b < 2; b++) {
+            DPFBlock keep = bit ? right[b] : left[b];
+            uint8_t tKeep = bit ? tRight[b] : tLeft[b];
+            s[b] = t[b] ? (keep ^ seedCW) : keep;
+            t[b] = tKeep ^ (t[b] & (bit ? tRightCW : tLeftCW));
+        }
+    }
+    key1.seedCW = key0.seedCW;
+    key1.tLeftCW = key0.tLeftCW;
+    key1.tRightCW = key0.tRightCW;
+
+    DPFBlock converted[2];
+    prg.convert(s, converted, 2);
+    uint64_t lane = alpha & ((1ULL << DPF_LEAF_BITS) - 1);
+    DPFBlock point;
+    (lane < 64 ? point.lo : point.hi) = 1ULL << (lane % 64);
+    key0.outputCW = key1.outputCW = converted[0] ^ converted[1] ^ point;
+}
+
+// ============================================================================
+// Full-domain evaluation
+// ============================================================================
+
+/**
+ * Replaces the nodes (seeds, ts) of `level` by their children
+ */
+static void expandLevel(DPFPrg& prg, const DPFKey& key, uint32_t level,
+                        std::vector<DPFBlock>& seeds, std::vector<uint8_t>& ts) {
+    uint64_t count = seeds.size();
+    std::vector<DPFBlock> left(count), right(count);
+    prg.expand(seeds.data(), left.data(), right.data(), count);
+
+    const DPFBlock& seedCW = key.seedCW[level];
+    std::vector<DPFBlock> nextSeeds(2 * count);
+    std::vector<uint8_t> nextTs(2 * count);
+    for (uint64_t i = 0; i < count; i++) {
+        uint8_t t = ts[i];
+        uint8_t tL = takeControlBit(left[i]);
+        uint8_t tR = takeControlBit(right[i]);
+        nextSeeds[2 * i] = t ? (left[i] ^ seedCW) : left[i];
+        nextSeeds[2 * i + 1] = t ? (right[i] ^ seedCW) : right[i];
+        nextTs[2 * i] = tL ^ (t & key.tLeftCW[level]);
+        nextTs[2 * i + 1] = tR ^ (t & key.tRightCW[level]);
+    }
+    seeds.swap(nextSeeds);
+    ts.swap(nextTs);
+}
+
+/**
+ * Expands the nodes (seeds, ts) of `level` down to the leaves and writes
+ * their outputs to out (2 words per leaf)
+ */
+static void expandSubtree(const DPFKey& key, std::vector<DPFBlock> seeds, std::vector<uint8_t> ts,
+                          uint32_t level, uint64_t* out) {
+    DPFPrg prg;
+    for (; level < key.depth; level++) {
+        expandLevel(prg, key, level, seeds, ts);
+    }
+
+    std::vector<DPFBlock> leaves(seeds.size());
+    prg.convert(seeds.data(), leaves.data(), seeds.size());
+    for (uint64_t i = 0; i < leaves.size(); i++) {
+        DPFBlock leaf = ts[i] ? (leaves[i] ^ key.outputCW) : leaves[i];
+        out[2 * i] = leaf.lo;
+        out[2 * i + 1] = leaf.hi;
+    }
+}
+
+void dpfEvalFull(const DPFKey& key, std::vector<uint64_t>& out, uint64_t numThreads) {
+    out.assign(2ULL << key.depth, 0);
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Expand the top of the tree until every thread gets a subtree
+    DPFPrg prg;
+    std::vector<DPFBlock> seeds = {key.seed};
+    std::vector<uint8_t> ts = {key.party};
+    uint32_t splitLevel = 0;
+    for (; splitLevel < key.depth && seeds.size() < numThreads; splitLevel++) {
+        expandLevel(prg, key, splitLevel, seeds, ts);
+    }
+
+    uint64_t nodes = seeds.size();
+    uint64_t leavesPerNode = 1ULL << (key.depth - splitLevel);
+    numThreads = std::min<uint64_t>(numThreads, nodes);
+    uint64_t nodesPerThread = (nodes + numThreads - 1) / numThreads;
+
+    std::vector<std::thread> workers;
+    for (uint64_t t = 0; t < numThreads; t++) {
+        uint64_t begin = t * nodesPerThread;
+        uint64_t end = std::min(nodes, begin + nodesPerThread);
+        if (begin >= end) break;
+        workers.emplace_back(expandSubtree, std::cref(key),
+                             std::vector<DPFBlock>(seeds.begin() + begin, seeds.begin() + end),
+                             std::vector<uint8_t>(ts.begin() + begin, ts.begin() + end),
+                             splitLevel, out.data() + 2 * begin * leavesPerNode);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// ============================================================================
+// Key serialization
+// ============================================================================
+
+std::vector<uint8_t> DPFKey::serialize() const {
+    std::vector<uint8_t> bytes;
+    auto put = [&bytes](const void* data, size_t size) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        bytes.insert(bytes.end(), p, p + size);
+    };
+    put(&party, sizeof(party));
+    put(&depth, sizeof(depth));
+    put(&seed, sizeof(seed));
+    for (uint32_t l = 0; l < depth; l++) {
+        put(&seedCW[l], sizeof(DPFBlock));
+        uint8_t ts = tLeftCW[l] | (tRightCW[l] << 1);
+        put(&ts, 1);
+    }
+    put(&outputCW, sizeof(outputCW));
+    return bytes;
+}
+
+bool DPFKey::deserialize(const uint8_t* data, size_t size, DPFKey& key) {
+    size_t offset = 0;
+    auto get = [&](void* dst, size_t n) {
+        if (offset + n > size) return false;
+        memcpy(dst, data + offset, n);
+        offset += n;
+        return true;
+    };
+    key = DPFKey();
+    if (!get(&key.party, sizeof(key.party)) || !get(&key.depth, sizeof(key.depth)) ||
+        !get(&key.seed, sizeof(key.seed)) || key.party > 1 || key.depth > 64) {
+        return false;
+    }
+    key.seedCW.resize(key.depth);
+    key.tLeftCW.resize(key.depth);
+    key.tRightCW.resize(key.depth);
+    for (uint32_t l = 0; l < key.depth; l++) {
+        uint8_t ts = 0;
+        if (!get(&key.seedCW[l], sizeof(DPFBlock)) || !get(&ts, 1)) {
+            return false;
+        }
+        key.tLeftCW[l] = ts & 1;
+        key.tRightCW[l] = (ts >> 1) & 1;
+    }
+    return get(&key.outputCW, sizeof(key.outputCW)) && offset == size;
+}
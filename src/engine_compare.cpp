@@ -0,0 +1,211 @@
+#include "engine_compare.h"
+#include "data_loader.h"
+#include "pir_kernels.h"
+#include "util.h"
+#include <openssl/sha.h>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+static uint64_t matrixBytes(const Matrix& M) {
+    return M.rows * M.cols * sizeof(Elem);
+}
+
+std::string EngineRun::name() const {
+    if (simplePIR) return honestHint ? "simplepir+hh" : "simplepir";
+    return honestHint ? "honest-hint" : "vlhepir";
+}
+
+// ============================================================================
+// One run
+// ============================================================================
+
+/**
+ * Full pipeline on db's entries under one combination. db.data is lent to
+ * the run's own VLHEPIR and taken back before it is destroyed
+ */
+static EngineRun runEngine(Database& db, uint64_t N, uint64_t d, uint64_t queryIndex,
+                           bool simplePIR, bool honestHint) {
+    EngineRun run;
+    run.simplePIR = simplePIR;
+    run.honestHint = honestHint;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    VLHEPIR pir(N, d, true, false, simplePIR, false, 1, honestHint);
+    run.setupMs = secondsSince(start_time) * 1000;
+    run.params = pir.dbParams;
+    if (pir.db.alloc) {
+        free(pir.db.data);
+    }
+    pir.db.data = db.data;
+    pir.db.alloc = true;
+
+    start_time = std::chrono::high_resolution_clock::now();
+    Matrix D = pir.db.packDataInMatrix(pir.dbParams, false);
+    PIRKernels kernels = selectKernels(pir.dbParams);
+    KernelMatrix D_packed = kernels.pack(D);
+    PackedMatrix D_proof;
+    if (!simplePIR) {
+        D_proof = packMatrixHardCoded(D, pir.lhe.p);
+    }
+    run.packMs = secondsSince(start_time) * 1000;
+
+    start_time = std::chrono::high_resolution_clock::now();
+    Matrix A = pir.Init();
+    run.initMs = secondsSince(start_time) * 1000;
+
+    start_time = std::chrono::high_resolution_clock::now();
+    Matrix H = pir.GenerateHint(A, D);
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    pir.HashAandH(hash, A, H);
+    run.hintMs = secondsSince(start_time) * 1000;
+
+    start_time = std::chrono::high_resolution_clock::now();
+    auto ct_sk = pir.Query(A, queryIndex);
+    run.queryMs = secondsSince(start_time) * 1000;
+    const Matrix& ct = std::get<0>(ct_sk);
+
+    start_time = std::chrono::high_resolution_clock::now();
+    Matrix ans = kernels.answer(D_packed, ct);
+    run.answerMs = secondsSince(start_time) * 1000;
+
+    if (!simplePIR) {
+        start_time = std::chrono::high_resolution_clock::now();
+        Matrix Z = pir.Prove(hash, ct, ans, D_proof);
+        run.proveMs = secondsSince(start_time) * 1000;
+        run.proofBytes = matrixBytes(Z);
+
+        start_time = std::chrono::high_resolution_clock::now();
+        pir.Verify(A, H, hash, ct, ans, Z, false);
+        run.verifyMs = secondsSince(start_time) * 1000;
+        run.verified = true;
+    }
+
+    start_time = std::chrono::high_resolution_clock::now();
+    entry_t result = pir.Recover(H, ans, std::get<1>(ct_sk), queryIndex);
+    run.recoverMs = secondsSince(start_time) * 1000;
+    run.correct = (result == db.getDataAtIndex(queryIndex));
+
+    run.serverBytes = matrixBytes(D) + D_packed.words.size() * sizeof(uint64_t) + matrixBytes(A) + matrixBytes(H);
+    run.clientBytes = matrixBytes(A) + matrixBytes(H);
+    run.hintBytes = matrixBytes(H);
+    run.queryBytes = matrixBytes(ct);
+    run.answerBytes = matrixBytes(ans);
+
+    // The entries belong to the caller
+    pir.db.data = nullptr;
+    pir.db.alloc = false;
+    return run;
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+
+void printEngineRuns(std::ostream& out, const std::vector<EngineRun>& runs) {
+    const int width = 14;
+    auto row = [&](const std::string& label, auto value) {
+        out << "  " << std::left << std::setw(18) << label << std::right;
+        for (const EngineRun& run : runs) {
+            out << std::setw(width) << value(run);
+        }
+        out << std::endl;
+    };
+    auto ms = [](double value) {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(2) << value;
+        return text.str();
+    };
+    auto kib = [](uint64_t bytes) {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(1) << bytes / 1024.0;
+        return text.str();
+    };
+
+    row("", [](const EngineRun& run) { return run.name(); });
+    row("ell x m", [](const EngineRun& run) {
+        return std::to_string(run.params.ell) + "x" + std::to_string(run.params.m);
+    });
+    row("setup (ms)", [&](const EngineRun& run) { return ms(run.setupMs); });
+    row("pack (ms)", [&](const EngineRun& run) { return ms(run.packMs); });
+    row("init A (ms)", [&](const EngineRun& run) { return ms(run.initMs); });
+    row("hint (ms)", [&](const EngineRun& run) { return ms(run.hintMs); });
+    row("query (ms)", [&](const EngineRun& run) { return ms(run.queryMs); });
+    row("answer (ms)", [&](const EngineRun& run) { return ms(run.answerMs); });
+    row("prove (ms)", [&](const EngineRun& run) { return ms(run.proveMs); });
+    row("verify (ms)", [&](const EngineRun& run) { return ms(run.verifyMs); });
+    row("recover (ms)", [&](const EngineRun& run) { return ms(run.recoverMs); });
+    row("online (ms)", [&](const EngineRun& run) { return ms(run.onlineMs()); });
+    row("server mem (KiB)", [&](const EngineRun& run) { return kib(run.serverBytes); });
+    row("client mem (KiB)", [&](const EngineRun& run) { return kib(run.clientBytes); });
+    row("hint (KiB)", [&](const EngineRun& run) { return kib(run.hintBytes); });
+    row("query (KiB)", [&](const EngineRun& run) { return kib(run.queryBytes); });
+    row("answer (KiB)", [&](const EngineRun& run) { return kib(run.answerBytes); });
+    row("proof (KiB)", [&](const EngineRun& run) { return kib(run.proofBytes); });
+    row("verified", [](const EngineRun& run) { return std::string(run.verified ? "yes" : "no"); });
+    row("correct", [](const EngineRun& run) { return std::string(run.correct ? "yes" : "NO"); });
+}
+
+void writeEngineRunsJSON(std::ostream& out, const std::vector<EngineRun>& runs) {
+    out << "[" << std::endl;
+    for (size_t i = 0; i < runs.size(); i++) {
+        const EngineRun& run = runs[i];
+        out << "  {\"engine\": \"" << run.name() << "\""
+            << ", \"simplePIR\": " << (run.simplePIR ? "true" : "false")
+            << ", \"honestHint\": " << (run.honestHint ? "true" : "false")
+            << ", \"N\": " << run.params.N << ", \"d\": " << run.params.d
+            << ", \"ell\": " << run.params.ell << ", \"m\": " << run.params.m << ", \"p\": " << run.params.p << "," << std::endl;
+        out << "   \"ms\": {\"setup\": " << run.setupMs << ", \"pack\": " << run.packMs
+            << ", \"init\": " << run.initMs << ", \"hint\": " << run.hintMs
+            << ", \"query\": " << run.queryMs << ", \"answer\": " << run.answerMs
+            << ", \"prove\": " << run.proveMs << ", \"verify\": " << run.verifyMs
+            << ", \"recover\": " << run.recoverMs << ", \"online\": " << run.onlineMs() << "}," << std::endl;
+        out << "   \"bytes\": {\"server\": " << run.serverBytes << ", \"client\": " << run.clientBytes
+            << ", \"hint\": " << run.hintBytes << ", \"query\": " << run.queryBytes
+            << ", \"answer\": " << run.answerBytes << ", \"proof\": " << run.proofBytes << "}," << std::endl;
+        out << "   \"verified\": " << (run.verified ? "true" : "false")
+            << ", \"correct\": " << (run.correct ? "true" : "false") << "}"
+            << (i + 1 < runs.size() ? "," : "") << std::endl;
+    }
+    out << "]" << std::endl;
+}
+
+// ============================================================================
+// Comparison
+// ============================================================================
+
+bool runEngineComparison(VLHEPIR& pir, uint64_t queryIndex, const std::string& jsonPath) {
+    std::cout << "=== Engine Comparison ===" << std::endl;
+    if (queryIndex >= pir.N) {
+        std::cerr << "Error: query index " << queryIndex << " out of bounds (max: " << (pir.N - 1) << ")" << std::endl;
+        return false;
+    }
+    if (!pir.db.alloc) {
+        fillRandomDatabase(pir.db, pir.dbParams.d, queryIndex);
+    }
+
+    // Same entries for every run, loaded once
+    std::vector<EngineRun> runs;
+    for (bool simplePIR : {false, true}) {
+        for (bool honestHint : {false, true}) {
+            runs.push_back(runEngine(pir.db, pir.N, pir.dbParams.d, queryIndex, simplePIR, honestHint));
+        }
+    }
+    printEngineRuns(std::cout, runs);
+
+    std::ofstream file(jsonPath);
+    if (!file.is_open()) {
+        std::cerr << "Error: unable to write " << jsonPath << std::endl;
+        return false;
+    }
+    writeEngineRunsJSON(file, runs);
+    std::cout << "Comparison written to " << jsonPath << std::endl;
+
+    bool ok = true;
+    for (const EngineRun& run : runs) {
+        ok = ok && run.correct;
+    }
+    return ok;
+}
@@ -0,0 +1,385 @@
+#include "engine_selector.h"
+#include "data_loader.h"
+#include "pir_kernels.h"
+#include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// Rows of each candidate layout actually scanned; the scan time of the
+// full matrix is extrapolated linearly from this sample
+static const uint64_t kSampleRows = 1024;
+
+// Query columns answered together when timing the hint product H = D * A
+static const uint64_t kHintBatch = 16;
+
+// Cost model of the verifiable engines (VeriSimplePIR): the proof is one
+// more pass over D per query and is as large as the answer, and checking a
+// malicious hint costs one more product of the size of the hint
+static const double kProofScans = 1.0;
+static const double kHintProofFactor = 2.0;
+
+// ============================================================================
+// Engine names
+// ============================================================================
+
+const char* engineName(Engine engine) {
+    switch (engine) {
+        case Engine::Trivial: return "trivial";
+        case Engine::SimplePIR: return "simplepir";
+        case Engine::VLHEPIR: return "vlhepir";
+        case Engine::HonestHint: return "honest-hint";
+    }
+    return "unknown";
+}
+
+bool parseEngine(const std::string& name, Engine& engine, bool& isAuto) {
+    isAuto = (name == "auto");
+    if (isAuto) return true;
+    for (Engine candidate : {Engine::Trivial, Engine::SimplePIR, Engine::VLHEPIR, Engine::HonestHint}) {
+        if (name == engineName(candidate)) {
+            engine = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// Estimates
+// ============================================================================
+
+static double transferSeconds(uint64_t bytes, const Workload& workload) {
+    return bytes * 8.0 / (workload.bandwidthMbps * 1e6);
+}
+
+/**
+ * Scan times of one (ell, m, p) layout: one query column, and per column
+ * of a kHintBatch-column batch (used for the hint product)
+ */
+struct ScanTiming {
+    double answerSeconds = 0;
+    double columnSeconds = 0;
+};
+
+static double timeAnswer(const PIRKernels& kernels, const KernelMatrix& D, const Matrix& ct, uint64_t numThreads) {
+    kernels.answer(D, ct, numThreads);  // warmup
+    uint64_t iters = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed(0);
+    while (iters < 10 && (iters < 2 || elapsed.count() < 0.05)) {
+        kernels.answer(D, ct, numThreads);
+        iters++;
+        elapsed = std::chrono::high_resolution_clock::now() - start_time;
+    }
+    return elapsed.count() / iters;
+}
+
+static ScanTiming timeScan(const DBParams& params, uint64_t numThreads) {
+    const uint64_t rows = std::min<uint64_t>(params.ell, kSampleRows);
+    Matrix D(rows, params.m);
+    random_fast(D, params.p);
+    PIRKernels kernels = selectKernels(params);
+    KernelMatrix D_packed = kernels.pack(D);
+
+    Matrix ct(params.m, 1);
+    random_fast(ct, params.p);
+    Matrix ctBatch(params.m, kHintBatch);
+    random_fast(ctBatch, params.p);
+
+    const double scale = double(params.ell) / rows;
+    ScanTiming timing;
+    timing.answerSeconds = timeAnswer(kernels, D_packed, ct, numThreads) * scale;
+    timing.columnSeconds = timeAnswer(kernels, D_packed, ctBatch, numThreads) * scale / kHintBatch;
+    return timing;
+}
+
+static EngineEstimate estimateTrivial(uint64_t N, uint64_t d, const Workload& workload) {
+    EngineEstimate estimate;
+    estimate.engine = Engine::Trivial;
+    estimate.params.N = N;
+    estimate.params.d = d;
+    estimate.hintBytes = (N * d + 7) / 8;
+    estimate.totalSeconds = transferSeconds(estimate.hintBytes, workload) + workload.latencyMs / 1000.0;
+    return estimate;
+}
+
+static EngineEstimate estimatePIR(Engine engine, uint64_t N, uint64_t d, const Workload& workload,
+                                  std::vector<std::pair<DBParams, ScanTiming>>& timings, uint64_t numThreads) {
+    EngineEstimate estimate;
+    estimate.engine = engine;
+    estimate.config.simplePIR = (engine == Engine::SimplePIR);
+    estimate.config.honestHint = (engine == Engine::HonestHint);
+
+    // Parameters only (randomData = false: no database is allocated)
+    VLHEPIR pir(N, d, estimate.config.allowTrivial, false, estimate.config.simplePIR,
+                false, estimate.config.batchSize, estimate.config.honestHint);
+    estimate.params = pir.dbParams;
+    const DBParams& params = pir.dbParams;
+
+    // Engines sharing a layout share its timing
+    ScanTiming timing;
+    bool found = false;
+    for (const auto& entry : timings) {
+        if (entry.first.ell == params.ell && entry.first.m == params.m && entry.first.p == params.p) {
+            timing = entry.second;
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        timing = timeScan(params, numThreads);
+        timings.push_back({params, timing});
+    }
+
+    const uint64_t elemBytes = sizeof(Elem);
+    const bool verifiable = (engine != Engine::SimplePIR);
+    const double hintSeconds = timing.columnSeconds * pir.lhe.n;
+    estimate.offlineSeconds = (engine == Engine::VLHEPIR) ? hintSeconds * kHintProofFactor : hintSeconds;
+    estimate.answerSeconds = timing.answerSeconds * (verifiable ? 1.0 + kProofScans : 1.0);
+    estimate.hintBytes = params.ell * pir.lhe.n * elemBytes;
+    estimate.uploadBytes = params.m * elemBytes;
+    estimate.downloadBytes = params.ell * elemBytes * (verifiable ? 2 : 1);
+
+    const double rtt = workload.latencyMs / 1000.0;
+    const double perQuery = estimate.answerSeconds + rtt
+                          + transferSeconds(estimate.uploadBytes + estimate.downloadBytes, workload);
+    estimate.totalSeconds = estimate.offlineSeconds + transferSeconds(estimate.hintBytes, workload) + rtt
+                          + workload.queries * perQuery;
+
+    if (engine == Engine::SimplePIR && workload.requireVerifiable) {
+        estimate.excluded = true;
+        estimate.reason = "answers are not verifiable";
+    } else if (engine == Engine::HonestHint && !workload.trustHint) {
+        estimate.excluded = true;
+        estimate.reason = "the hint is not checked and the client does not trust the server";
+    }
+    return estimate;
+}
+
+static EngineChoice estimateAll(uint64_t N, uint64_t d, const Workload& workload, uint64_t numThreads) {
+    EngineChoice choice;
+    std::vector<std::pair<DBParams, ScanTiming>> timings;
+    choice.candidates.push_back(estimateTrivial(N, d, workload));
+    for (Engine engine : {Engine::VLHEPIR, Engine::HonestHint, Engine::SimplePIR}) {
+        choice.candidates.push_back(estimatePIR(engine, N, d, workload, timings, numThreads));
+    }
+    return choice;
+}
+
+static std::string formatSeconds(double seconds) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(seconds < 1.0 ? 4 : 2) << seconds << " s";
+    return out.str();
+}
+
+/**
+ * Picks the cheapest allowed candidate (first one on ties) and explains
+ * the exclusions, the choice and the trivial / PIR break-even point
+ */
+static void decide(EngineChoice& choice, const Workload& workload, const Engine* forced) {
+    const EngineEstimate* best = nullptr;
+    const EngineEstimate* bestPIR = nullptr;
+    for (const EngineEstimate& estimate : choice.candidates) {
+        if (estimate.excluded) {
+            choice.reasoning.push_back(std::string(engineName(estimate.engine)) + " excluded: " + estimate.reason);
+            continue;
+        }
+        if (!best || estimate.totalSeconds < best->totalSeconds) best = &estimate;
+        if (estimate.engine != Engine::Trivial && (!bestPIR || estimate.totalSeconds < bestPIR->totalSeconds)) {
+            bestPIR = &estimate;
+        }
+    }
+
+    const EngineEstimate& trivial = choice.candidates.front();
+    if (bestPIR) {
+        // Trivial costs the same for any number of queries, PIR grows linearly
+        const double rtt = workload.latencyMs / 1000.0;
+        const double fixed = bestPIR->offlineSeconds + transferSeconds(bestPIR->hintBytes, workload) + rtt;
+        const double perQuery = (bestPIR->totalSeconds - fixed) / workload.queries;
+        std::ostringstream line;
+        line << "trivial download of " << formatBytes(trivial.hintBytes) << " takes "
+             << formatSeconds(trivial.totalSeconds) << "; " << engineName(bestPIR->engine) << " costs "
+             << formatSeconds(fixed) << " once then " << formatSeconds(perQuery) << " per query";
+        if (fixed >= trivial.totalSeconds) {
+            line << ", so the download is cheaper for any number of queries";
+        } else if (perQuery <= 0) {
+            line << ", so PIR is cheaper for any number of queries";
+        } else {
+            uint64_t breakEven = uint64_t((trivial.totalSeconds - fixed) / perQuery);
+            line << ", so PIR is cheaper up to " << breakEven << " queries";
+        }
+        choice.reasoning.push_back(line.str());
+    }
+
+    if (forced) {
+        choice.forced = true;
+        for (const EngineEstimate& estimate : choice.candidates) {
+            if (estimate.engine == *forced) choice.chosen = estimate;
+        }
+        std::ostringstream line;
+        line << "chosen: " << engineName(*forced) << " (imposed by --engine, estimated "
+             << formatSeconds(choice.chosen.totalSeconds) << ")";
+        if (best && best->engine != *forced) {
+            line << "; the cheapest allowed engine is " << engineName(best->engine) << " ("
+                 << formatSeconds(best->totalSeconds) << ")";
+        }
+        choice.reasoning.push_back(line.str());
+        return;
+    }
+
+    // Trivial is never excluded, so there always is a best candidate
+    choice.chosen = *best;
+    std::ostringstream line;
+    line << "chosen: " << engineName(best->engine) << ", the cheapest allowed engine for "
+         << workload.queries << " queries (" << formatSeconds(best->totalSeconds) << ")";
+    choice.reasoning.push_back(line.str());
+}
+
+EngineChoice selectEngine(uint64_t N, uint64_t d, const Workload& workload, uint64_t numThreads) {
+    EngineChoice choice = estimateAll(N, d, workload, numThreads);
+    decide(choice, workload, nullptr);
+    return choice;
+}
+
+EngineChoice selectEngine(uint64_t N, uint64_t d, const Workload& workload, Engine forced, uint64_t numThreads) {
+    EngineChoice choice = estimateAll(N, d, workload, numThreads);
+    decide(choice, workload, &forced);
+    return choice;
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+
+void EngineChoice::print(std::ostream& out, const Workload& workload) const {
+    out << "=== Engine Selection ===" << std::endl;
+    out << "Workload: " << workload.queries << " queries, " << workload.bandwidthMbps << " Mbit/s, "
+        << workload.latencyMs << " ms round trip"
+        << (workload.requireVerifiable ? ", verifiable answers required" : "")
+        << (workload.trustHint ? ", hint trusted" : "") << std::endl;
+    out << std::left << std::setw(15) << "  engine" << std::setw(13) << "offline" << std::setw(13) << "answer/q"
+        << std::setw(12) << "hint" << std::setw(12) << "up/q" << std::setw(12) << "down/q" << "total" << std::endl;
+    for (const EngineEstimate& estimate : candidates) {
+        out << "  " << std::setw(13) << engineName(estimate.engine)
+            << std::setw(13) << formatSeconds(estimate.offlineSeconds)
+            << std::setw(13) << formatSeconds(estimate.answerSeconds)
+            << std::setw(12) << formatBytes(estimate.hintBytes)
+            << std::setw(12) << formatBytes(estimate.uploadBytes)
+            << std::setw(12) << formatBytes(estimate.downloadBytes)
+            << formatSeconds(estimate.totalSeconds) << (estimate.excluded ? " (excluded)" : "") << std::endl;
+    }
+    out << std::right;
+    for (const std::string& line : reasoning) {
+        out << "- " << line << std::endl;
+    }
+}
+
+static std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void EngineChoice::writeJSON(std::ostream& out, const Workload& workload) const {
+    out << "{" << std::endl;
+    out << "  \"workload\": {\"queries\": " << workload.queries << ", \"bandwidth_mbps\": " << workload.bandwidthMbps
+        << ", \"latency_ms\": " << workload.latencyMs << ", \"require_verifiable\": "
+        << (workload.requireVerifiable ? "true" : "false") << ", \"trust_hint\": "
+        << (workload.trustHint ? "true" : "false") << "}," << std::endl;
+    out << "  \"candidates\": [" << std::endl;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const EngineEstimate& estimate = candidates[i];
+        out << "    {\"engine\": \"" << engineName(estimate.engine) << "\""
+            << ", \"ell\": " << estimate.params.ell << ", \"m\": " << estimate.params.m << ", \"p\": " << estimate.params.p
+            << ", \"offline_s\": " << estimate.offlineSeconds << ", \"answer_s\": " << estimate.answerSeconds
+            << ", \"hint_bytes\": " << estimate.hintBytes << ", \"upload_bytes\": " << estimate.uploadBytes
+            << ", \"download_bytes\": " << estimate.downloadBytes << ", \"total_s\": " << estimate.totalSeconds
+            << ", \"excluded\": " << (estimate.excluded ? "true" : "false");
+        if (estimate.excluded) {
+            out << ", \"reason\": \"" << jsonEscape(estimate.reason) << "\"";
+        }
+        out << "}" << (i + 1 < candidates.size() ? "," : "") << std::endl;
+    }
+    out << "  ]," << std::endl;
+    out << "  \"chosen\": \"" << engineName(chosen.engine) << "\", \"forced\": " << (forced ? "true" : "false") << "," << std::endl;
+    out << "  \"reasoning\": [" << std::endl;
+    for (size_t i = 0; i < reasoning.size(); i++) {
+        out << "    \"" << jsonEscape(reasoning[i]) << "\"" << (i + 1 < reasoning.size() ? "," : "") << std::endl;
+    }
+    out << "  ]" << std::endl;
+    out << "}" << std::endl;
+}
+
+bool saveEngineReport(const EngineChoice& choice, const Workload& workload, const std::string& path) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: unable to write report " << path << std::endl;
+        return false;
+    }
+    const std::string suffix = ".json";
+    if (path.size() >= suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        choice.writeJSON(file, workload);
+    } else {
+        choice.print(file, workload);
+    }
+    return true;
+}
+
+// ============================================================================
+// Trivial engine
+// ============================================================================
+
+bool runTrivialDownload(VLHEPIR& pir, uint64_t queryIndex, const Workload& workload) {
+    std::cout << "=== Trivial Download ===" << std::endl;
+    const uint64_t N = pir.N;
+    const uint64_t d = pir.dbParams.d;
+    if (queryIndex >= N) {
+        std::cerr << "Error: query index " << queryIndex << " out of bounds (max: " << (N - 1) << ")" << std::endl;
+        return false;
+    }
+    if (d > 64) {
+        std::cerr << "Error: trivial download supports entries of at most 64 bits" << std::endl;
+        return false;
+    }
+    if (!pir.db.alloc) {
+        fillRandomDatabase(pir.db, d, queryIndex);
+    }
+
+    // Server: the whole database, d bits per entry
+    auto start_time = std::chrono::high_resolution_clock::now();
+    const uint64_t mask = (d == 64) ? UINT64_MAX : ((1ULL << d) - 1);
+    std::vector<uint64_t> words((N * d + 63) / 64 + 1, 0);
+    for (uint64_t i = 0; i < N; i++) {
+        uint64_t value = pir.db.getDataAtIndex(i).toUnsignedLong() & mask;
+        uint64_t bit = i * d;
+        words[bit / 64] |= value << (bit % 64);
+        if (bit % 64 + d > 64) {
+            words[bit / 64 + 1] |= value >> (64 - bit % 64);
+        }
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    const uint64_t bytes = (N * d + 7) / 8;
+    std::cout << "Database serialized: " << formatBytes(bytes) << " in " << duration.count() << " ms" << std::endl;
+    std::cout << "Download time at " << workload.bandwidthMbps << " Mbit/s: "
+              << formatSeconds(transferSeconds(bytes, workload) + workload.latencyMs / 1000.0) << std::endl;
+
+    // Client: every later query is a local lookup
+    uint64_t bit = queryIndex * d;
+    uint64_t value = words[bit / 64] >> (bit % 64);
+    if (bit % 64 + d > 64) {
+        value |= words[bit / 64 + 1] << (64 - bit % 64);
+    }
+    value &= mask;
+
+    entry_t expected = pir.db.getDataAtIndex(queryIndex);
+    std::cout << "Recovered value: " << value << " (expected: " << expected.toUnsignedLong() << ")" << std::endl;
+    return value == expected.toUnsignedLong();
+}
@@ -0,0 +1,116 @@
+#include "fused_pir.h"
+#include "data_loader.h"
+#include "pir_kernels.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+// ============================================================================
+// Fused queries over same-shaped databases
+// ============================================================================
+
+bool runFusedPIR(const std::string& filePath,
+                 const std::vector<std::string>& columns,
+                 uint64_t d,
+                 uint64_t queryIndex,
+                 bool hasHeader,
+                 const PIRConfig& config) {
+    std::cout << "=== Fused PIR over " << columns.size() << " databases ===" << std::endl;
+    std::vector<std::vector<uint64_t>> values;
+    bool loaded = (detectFileFormat(filePath) == FileFormat::PARQUET)
+        ? readParquetColumns(values, filePath, columns)
+        : readCSVColumns(values, filePath, columns, hasHeader);
+    if (!loaded || values.empty() || values[0].empty()) {
+        std::cerr << "Error: no data found in " << filePath << std::endl;
+        return false;
+    }
+    uint64_t N = values[0].size();
+    if (queryIndex >= N) {
+        std::cerr << "Error: query index " << queryIndex << " out of bounds (max: " << (N - 1) << ")" << std::endl;
+        return false;
+    }
+
+    // A common d keeps dbParams (and therefore A and the query) identical
+    if (d == 0) {
+        uint64_t maxValue = 0;
+        for (const auto& column : values) {
+            maxValue = std::max(maxValue, *std::max_element(column.begin(), column.end()));
+        }
+        d = calculateBitSize(maxValue);
+    }
+    const uint64_t maxValue = (d >= 64) ? UINT64_MAX : ((1ULL << d) - 1);
+    for (uint64_t k = 0; k < columns.size(); k++) {
+        auto wide = std::find_if(values[k].begin(), values[k].end(), [&](uint64_t v) { return v > maxValue; });
+        if (wide != values[k].end()) {
+            std::cerr << "Error: value too large in column " << columns[k] << " at row "
+                      << (wide - values[k].begin()) << ": " << *wide << " (max for d=" << d << ": "
+                      << maxValue << "), use a larger --d or --d auto" << std::endl;
+            return false;
+        }
+    }
+    std::cout << "Databases: " << columns.size() << " x " << N << " entries of " << d << " bits" << std::endl;
+
+    std::vector<std::unique_ptr<VLHEPIR>> pirs;
+    for (uint64_t k = 0; k < columns.size(); k++) {
+        pirs.emplace_back(new VLHEPIR(N, d, config.allowTrivial, config.verbose, config.simplePIR,
+                                      false, config.batchSize, config.honestHint));
+        Database& db = pirs[k]->db;
+        if (!db.alloc) {
+            db.data = (entry_t*)malloc(N * sizeof(entry_t));
+            db.alloc = true;
+        }
+        selectKernels(d, 0).load(db, 0, values[k].data(), N);
+    }
+    VLHEPIR& pir = *pirs[0];
+    std::cout << "Database parameters: ";
+    pir.dbParams.print();
+
+    // Offline phase: one A, one hint per database, interleaved storage
+    PIRKernels kernels = selectKernels(pir.dbParams);
+    Matrix A = pir.Init();
+    std::vector<Matrix> hints;
+    std::vector<KernelMatrix> packed;
+    for (auto& p : pirs) {
+        Matrix D = p->db.packDataInMatrix(p->dbParams, false);
+        hints.push_back(p->GenerateHint(A, D));
+        packed.push_back(kernels.pack(D));
+    }
+    std::vector<const KernelMatrix*> parts;
+    for (const auto& D : packed) {
+        parts.push_back(&D);
+    }
+    FusedKernelMatrix fused;
+    if (!fuseKernelMatrices(parts, fused)) {
+        return false;
+    }
+
+    // Online phase: one ciphertext for all databases
+    auto ct_sk = pir.Query(A, queryIndex);
+    const Matrix& ct = std::get<0>(ct_sk);
+    const Matrix& sk = std::get<1>(ct_sk);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (const auto& D : packed) {
+        kernels.answer(D, ct);
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto separate = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+
+    start_time = std::chrono::high_resolution_clock::now();
+    std::vector<Matrix> answers = kernels.answerFused(fused, ct);
+    end_time = std::chrono::high_resolution_clock::now();
+    auto fusedTime = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+    std::cout << "Answer time: " << fusedTime.count() / 1000.0 << " ms fused, "
+              << separate.count() / 1000.0 << " ms as " << columns.size() << " separate scans" << std::endl;
+
+    bool ok = true;
+    for (uint64_t k = 0; k < pirs.size(); k++) {
+        entry_t result = pirs[k]->Recover(hints[k], answers[k], sk, queryIndex);
+        bool match = (result == pirs[k]->db.getDataAtIndex(queryIndex));
+        std::cout << "  " << columns[k] << "[" << queryIndex << "] = " << result.toUnsignedLong()
+                  << (match ? "" : " (mismatch)") << std::endl;
+        ok = ok && match;
+    }
+    return ok;
+}
@@ -0,0 +1,82 @@
+#include "hint_bench.h"
+#include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+static bool sameMatrix(const Matrix& X, const Matrix& Y) {
+    return X.rows == Y.rows && X.cols == Y.cols && std::equal(X.data, X.data + X.rows * X.cols, Y.data);
+}
+
+double hintGigaOps(const KernelMatrix& D, uint64_t n) {
+    return 2.0 * D.rows * D.cols * n / 1e9;
+}
+
+std::vector<HintRun> measureHintScaling(const PIRKernels& kernels, const KernelMatrix& D,
+                                        const Matrix& A, const Matrix& H, uint64_t maxThreads) {
+    if (maxThreads == 0) {
+        maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<uint64_t> counts;
+    for (uint64_t threads = 1; threads < maxThreads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(maxThreads);
+
+    std::vector<HintRun> runs;
+    for (uint64_t threads : counts) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        Matrix result = kernels.hint(D, A, threads);
+        HintRun run;
+        run.threads = threads;
+        run.seconds = secondsSince(start_time);
+        run.gflops = run.seconds > 0 ? hintGigaOps(D, A.cols) / run.seconds : 0;
+        if (!sameMatrix(result, H)) {
+            std::cerr << "Error: blocked hint on " << threads << " threads differs from GenerateHint" << std::endl;
+            return {};
+        }
+        runs.push_back(run);
+    }
+    return runs;
+}
+
+bool runHintBenchmark(VLHEPIR& pir, const PIRKernels& kernels, const Matrix& D,
+                      const KernelMatrix& D_packed, const Matrix& A, uint64_t maxThreads) {
+    std::cout << "=== Hint Kernel Benchmark ===" << std::endl;
+    std::cout << "H = D * A: " << D_packed.rows << " x " << D_packed.cols << " by " << A.cols
+              << " (" << hintGigaOps(D_packed, A.cols) << " GFLOP-equivalent), panels of "
+              << HINT_BLOCK_COLS << " columns in " << (HINT_BLOCK_BYTES >> 10) << " KiB" << std::endl;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    Matrix H = pir.GenerateHint(A, D);
+    double librarySeconds = secondsSince(start_time);
+    std::vector<HintRun> runs = measureHintScaling(kernels, D_packed, A, H, maxThreads);
+    if (runs.empty()) {
+        return false;
+    }
+
+    const double ops = hintGigaOps(D_packed, A.cols);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(14) << "kernel" << std::right << std::setw(12) << "ms"
+              << std::setw(10) << "GFLOP/s" << std::setw(10) << "speedup" << std::setw(12) << "efficiency"
+              << std::setw(12) << "vs library" << std::endl;
+    std::cout << std::left << std::setw(14) << "GenerateHint" << std::right << std::setw(12) << librarySeconds * 1000
+              << std::setw(10) << (librarySeconds > 0 ? ops / librarySeconds : 0) << std::setw(10) << "-"
+              << std::setw(12) << "-" << std::setw(12) << "1.00x" << std::endl;
+    for (const HintRun& run : runs) {
+        double speedup = run.seconds > 0 ? runs[0].seconds / run.seconds : 0;
+        std::ostringstream label, versus;
+        label << "blocked x" << run.threads;
+        versus << std::fixed << std::setprecision(2) << (run.seconds > 0 ? librarySeconds / run.seconds : 0) << "x";
+        std::cout << std::left << std::setw(14) << label.str() << std::right << std::setw(12) << run.seconds * 1000
+                  << std::setw(10) << run.gflops << std::setw(10) << speedup
+                  << std::setw(11) << 100.0 * speedup / run.threads << "%" << std::setw(12) << versus.str() << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+    std::cout << "All blocked hints match GenerateHint" << std::endl;
+    return true;
+}
@@ -0,0 +1,192 @@
+#include "hint_checkpoint.h"
+#include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+#include <vector>
+
+// First 8 bytes of a checkpoint, and where A starts (after the header page)
+static const char kCheckpointMagic[8] = {'P', 'I', 'R', 'H', 'I', 'N', 'T', '1'};
+static const uint64_t kCheckpointDataOffset = 4096;
+
+/**
+ * Header fields, in file order after the magic
+ */
+struct CheckpointHeader {
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    uint64_t rows;
+    uint64_t m;
+    uint64_t n;
+    uint64_t rowsDone;
+};
+
+// ============================================================================
+// Checkpoint file
+// ============================================================================
+
+HintCheckpoint::~HintCheckpoint() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool HintCheckpoint::writeHeader() {
+    char header[sizeof(kCheckpointMagic) + sizeof(CheckpointHeader)];
+    CheckpointHeader fields;
+    memcpy(fields.digest, digest_, sizeof(digest_));
+    fields.rows = rows_;
+    fields.m = m_;
+    fields.n = n_;
+    fields.rowsDone = rowsDone_;
+    memcpy(header, kCheckpointMagic, sizeof(kCheckpointMagic));
+    memcpy(header + sizeof(kCheckpointMagic), &fields, sizeof(fields));
+    return writeAll(fd_, header, sizeof(header), 0) && fsync(fd_) == 0;
+}
+
+bool HintCheckpoint::load(const unsigned char digest[SHA256_DIGEST_LENGTH], uint64_t rows,
+                          Matrix& A, Matrix& H, uint64_t& rowsDone) {
+    int fd = open(path_.c_str(), O_RDWR);
+    if (fd < 0) {
+        return false;
+    }
+    char header[sizeof(kCheckpointMagic) + sizeof(CheckpointHeader)];
+    CheckpointHeader fields;
+    if (!readAll(fd, header, sizeof(header), 0) || memcmp(header, kCheckpointMagic, sizeof(kCheckpointMagic)) != 0) {
+        std::cerr << "Warning: " << path_ << " is not a hint checkpoint, starting over" << std::endl;
+        close(fd);
+        return false;
+    }
+    memcpy(&fields, header + sizeof(kCheckpointMagic), sizeof(fields));
+    if (memcmp(fields.digest, digest, SHA256_DIGEST_LENGTH) != 0 || fields.rows != rows || fields.rowsDone > rows) {
+        std::cerr << "Warning: checkpoint " << path_ << " belongs to another database, starting over" << std::endl;
+        close(fd);
+        return false;
+    }
+
+    const uint64_t elemBytes = sizeof(Elem);
+    A = Matrix(fields.m, fields.n);
+    H = Matrix(rows, fields.n);
+    if (!readAll(fd, A.data, fields.m * fields.n * elemBytes, kCheckpointDataOffset) ||
+        !readAll(fd, H.data, fields.rowsDone * fields.n * elemBytes,
+                 kCheckpointDataOffset + fields.m * fields.n * elemBytes)) {
+        std::cerr << "Warning: checkpoint " << path_ << " is truncated, starting over" << std::endl;
+        close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    memcpy(digest_, digest, sizeof(digest_));
+    rows_ = rows;
+    m_ = fields.m;
+    n_ = fields.n;
+    rowsDone_ = rowsDone = fields.rowsDone;
+    return true;
+}
+
+bool HintCheckpoint::create(const unsigned char digest[SHA256_DIGEST_LENGTH], uint64_t rows, const Matrix& A) {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+    fd_ = open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Error: unable to create checkpoint " << path_ << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    memcpy(digest_, digest, sizeof(digest_));
+    rows_ = rows;
+    m_ = A.rows;
+    n_ = A.cols;
+    rowsDone_ = 0;
+    if (!writeAll(fd_, A.data, m_ * n_ * sizeof(Elem), kCheckpointDataOffset) || !writeHeader()) {
+        std::cerr << "Error: unable to write checkpoint " << path_ << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool HintCheckpoint::commit(const Matrix& H, uint64_t firstRow, uint64_t count) {
+    const uint64_t rowBytes = n_ * sizeof(Elem);
+    const uint64_t offset = kCheckpointDataOffset + m_ * rowBytes + firstRow * rowBytes;
+    // The rows must be on disk before the header counts them
+    if (!writeAll(fd_, H.data + firstRow * n_, count * rowBytes, offset) || fsync(fd_) != 0) {
+        std::cerr << "Error: unable to write checkpoint " << path_ << std::endl;
+        return false;
+    }
+    rowsDone_ = firstRow + count;
+    if (!writeHeader()) {
+        std::cerr << "Error: unable to write checkpoint " << path_ << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Tiled hint generation
+// ============================================================================
+
+void digestKernelMatrix(const KernelMatrix& D, unsigned char digest[SHA256_DIGEST_LENGTH]) {
+    SHA256_CTX ctx;
+    SHA256_Init(&ctx);
+    uint64_t shape[5] = {D.rows, D.cols, D.logp, D.digitsPerWord, D.wordsPerRow};
+    SHA256_Update(&ctx, shape, sizeof(shape));
+    SHA256_Update(&ctx, D.data(), D.rows * D.wordsPerRow * sizeof(uint64_t));
+    SHA256_Final(digest, &ctx);
+}
+
+bool generateHintCheckpointed(VLHEPIR& pir, const PIRKernels& kernels, const KernelMatrix& D,
+                              const std::string& path, const HintTiling& tiling, Matrix& A, Matrix& H) {
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    digestKernelMatrix(D, digest);
+
+    HintCheckpoint checkpoint(path);
+    uint64_t rowsDone = 0;
+    if (checkpoint.load(digest, D.rows, A, H, rowsDone)) {
+        std::cout << "Hint checkpoint " << path << ": resuming at row " << rowsDone
+                  << " of " << D.rows << std::endl;
+    } else {
+        A = pir.Init();
+        H = Matrix(D.rows, A.cols);
+        if (!checkpoint.create(digest, D.rows, A)) {
+            return false;
+        }
+        std::cout << "Hint checkpoint " << path << ": started (" << D.rows << " rows)" << std::endl;
+    }
+    if (A.rows != D.cols) {
+        std::cerr << "Error: A has " << A.rows << " rows, database has " << D.cols << " columns" << std::endl;
+        return false;
+    }
+
+    // Every tile is rows [r, r + tileRows) of H = D * A
+    const uint64_t n = A.cols;
+    const uint64_t tileRows = std::max<uint64_t>(tiling.tileRows, 1);
+    std::vector<Elem> padded = padQuery(A, D.wordsPerRow * D.digitsPerWord);
+    KernelMatrix tile;
+    tile.cols = D.cols;
+    tile.logp = D.logp;
+    tile.digitsPerWord = D.digitsPerWord;
+    tile.wordsPerRow = D.wordsPerRow;
+
+    uint64_t committed = rowsDone;
+    auto lastCheckpoint = std::chrono::steady_clock::now();
+    for (uint64_t row = rowsDone; row < D.rows; row += tileRows) {
+        tile.rows = std::min(tileRows, D.rows - row);
+        tile.external = D.data() + row * D.wordsPerRow;
+        kernels.hintBlock(H.data + row * n, tile, padded.data(), n, tiling.threads);
+
+        const uint64_t done = row + tile.rows;
+        std::chrono::duration<double> sinceCheckpoint = std::chrono::steady_clock::now() - lastCheckpoint;
+        if (done == D.rows || sinceCheckpoint.count() >= tiling.checkpointSeconds) {
+            if (!checkpoint.commit(H, committed, done - committed)) {
+                return false;
+            }
+            std::cout << "  checkpoint: " << done << " / " << D.rows << " rows" << std::endl;
+            committed = done;
+            lastCheckpoint = std::chrono::steady_clock::now();
+        }
+    }
+    return true;
+}
@@ -0,0 +1,259 @@
+#include "keyword_pir.h"
+#include "data_loader.h"
+#include "pir_kernels.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <unordered_set>
+
+// ============================================================================
+// Cuckoo hash table laid out as the PIR database
+// ============================================================================
+
+uint64_t KeywordParams::slotOf(uint64_t keyHash, uint64_t j) const {
+    return mix64(keyHash ^ mix64(seed + j)) % numSlots;
+}
+
+uint64_t KeywordParams::fingerprintOf(uint64_t keyHash) const {
+    uint64_t mask = (fingerprintBits >= 64) ? UINT64_MAX : ((1ULL << fingerprintBits) - 1);
+    uint64_t fingerprint = mix64(keyHash ^ seed) & mask;
+    return (fingerprint == 0) ? 1 : fingerprint;  // 0 marks an empty slot
+}
+
+uint64_t hashKey(const std::string& key) {
+    // FNV-1a, then mixed
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : key) {
+        h = (h ^ c) * 0x100000001b3ULL;
+    }
+    return mix64(h);
+}
+
+bool buildKeywordTable(const std::vector<std::string>& keys,
+                       uint64_t d,
+                       KeywordParams& params,
+                       std::vector<uint64_t>& slots) {
+    if (d + 16 > 64) {
+        std::cerr << "Error: keyword mode needs d <= 48 (fingerprints use at least 16 bits)" << std::endl;
+        return false;
+    }
+    params.d = d;
+    params.fingerprintBits = std::min<uint64_t>(32, 64 - d);
+    // 3-way cuckoo hashing stays reliable below ~90% load
+    params.numSlots = std::max<uint64_t>(keys.size() + keys.size() / 4, 4);
+
+    std::vector<uint64_t> hashes(keys.size());
+    std::unordered_set<std::string> seen;
+    for (uint64_t record = 0; record < keys.size(); record++) {
+        if (!seen.insert(keys[record]).second) {
+            std::cerr << "Error: duplicate key '" << keys[record] << "' at record " << record << std::endl;
+            return false;
+        }
+        hashes[record] = hashKey(keys[record]);
+    }
+
+    const uint64_t maxEvictions = 1000;
+    const int maxSeeds = 16;
+    for (int attempt = 0; attempt < maxSeeds; attempt++) {
+        params.seed = mix64(0x6b657977 + attempt);
+        slots.assign(params.numSlots, 0);
+        std::mt19937_64 rng(params.seed);
+
+        bool ok = true;
+        for (uint64_t record = 0; record < keys.size() && ok; record++) {
+            uint64_t current = record + 1;
+            bool placed = false;
+            for (uint64_t step = 0; step < maxEvictions && !placed; step++) {
+                uint64_t h = hashes[current - 1];
+                for (uint64_t j = 0; j < params.numHashes; j++) {
+                    uint64_t s = params.slotOf(h, j);
+                    if (slots[s] == 0) {
+                        slots[s] = current;
+                        placed = true;
+                        break;
+                    }
+                }
+                if (!placed) {
+                    uint64_t s = params.slotOf(h, rng() % params.numHashes);
+                    std::swap(current, slots[s]);
+                }
+            }
+            ok = placed;
+        }
+        // A key must be the only one with its fingerprint among its
+        // candidate slots, the client stops at the first match
+        for (uint64_t record = 0; record < keys.size() && ok; record++) {
+            uint64_t fingerprint = params.fingerprintOf(hashes[record]);
+            for (uint64_t j = 0; j < params.numHashes && ok; j++) {
+                uint64_t other = slots[params.slotOf(hashes[record], j)];
+                ok = other == 0 || other == record + 1 || params.fingerprintOf(hashes[other - 1]) != fingerprint;
+            }
+        }
+        if (ok) {
+            return true;
+        }
+    }
+    std::cerr << "Error: no cuckoo table without insertion failure or fingerprint collision in "
+              << maxSeeds << " seeds (" << params.fingerprintBits << "-bit fingerprints, a smaller d widens them)"
+              << std::endl;
+    return false;
+}
+
+// ============================================================================
+// Keyword PIR
+// ============================================================================
+
+VLHEPIR createKeywordVLHEPIRFromFile(const std::string& filePath,
+                                     uint64_t d,
+                                     const std::string& keyColumn,
+                                     KeywordParams& params,
+                                     const std::string& columnName,
+                                     bool hasHeader,
+                                     const PIRConfig& config) {
+    std::vector<std::string> keys;
+    std::unique_ptr<Database> records = loadRecordsWithKeys(filePath, d, keyColumn, keys, columnName, hasHeader);
+    if (!records) {
+        exit(1);
+    }
+    return createKeywordVLHEPIR(keys, *records, d, params, config);
+}
+
+VLHEPIR createKeywordVLHEPIR(const std::vector<std::string>& keys,
+                             const Database& records,
+                             uint64_t d,
+                             KeywordParams& params,
+                             const PIRConfig& config) {
+    std::vector<uint64_t> slots;
+    if (!buildKeywordTable(keys, d, params, slots)) {
+        exit(1);
+    }
+
+    if (config.verbose) {
+        std::cout << "Keyword table:" << std::endl;
+        std::cout << "  Keys: " << keys.size() << std::endl;
+        std::cout << "  Slots: " << params.numSlots << " (" << params.numHashes << " hash functions)" << std::endl;
+        std::cout << "  Slot entry: " << params.fingerprintBits << "-bit fingerprint + " 
+                  << d << "-bit value" << std::endl;
+    }
+
+    VLHEPIR pir(params.numSlots, params.entryBits(), config.allowTrivial, config.verbose,
+                config.simplePIR, false, config.batchSize, config.honestHint);
+    if (pir.db.alloc) {
+        free(pir.db.data);
+    }
+    pir.db.data = (entry_t*)malloc(pir.N * sizeof(entry_t));
+    pir.db.alloc = true;
+    for (uint64_t s = 0; s < pir.N; s++) {
+        if (s >= slots.size() || slots[s] == 0) {
+            pir.db.data[s] = entry_t(0);
+            continue;
+        }
+        uint64_t record = slots[s] - 1;
+        uint64_t fingerprint = params.fingerprintOf(hashKey(keys[record]));
+        pir.db.data[s] = (entry_t(static_cast<unsigned long>(fingerprint)) << d) + records.data[record];
+    }
+    return pir;
+}
+
+Matrix KeywordPIRClient::Query(VLHEPIR& pir, const Matrix& A, const KeywordParams& params, const std::string& key) {
+    params_ = params;
+    uint64_t h = hashKey(key);
+    fingerprint_ = params.fingerprintOf(h);
+
+    slots_.clear();
+    sks_.clear();
+    for (uint64_t j = 0; j < params.numHashes; j++) {
+        slots_.push_back(params.slotOf(h, j));
+    }
+
+    // Column j of the batched query is the query for candidate slot j
+    Matrix ct(A.rows, slots_.size());
+    for (uint64_t j = 0; j < slots_.size(); j++) {
+        auto ct_sk = pir.Query(A, slots_[j]);
+        const Matrix& ct_j = std::get<0>(ct_sk);
+        for (uint64_t r = 0; r < ct_j.rows; r++) {
+            ct.data[r * ct.cols + j] = ct_j.data[r];
+        }
+        sks_.push_back(std::get<1>(ct_sk));
+    }
+    return ct;
+}
+
+bool KeywordPIRClient::Recover(VLHEPIR& pir, const Matrix& H, const Matrix& ans, uint64_t& value) const {
+    const uint64_t valueMask = (params_.d >= 64) ? UINT64_MAX : ((1ULL << params_.d) - 1);
+    for (uint64_t j = 0; j < slots_.size(); j++) {
+        Matrix ans_j(ans.rows, 1);
+        for (uint64_t r = 0; r < ans.rows; r++) {
+            ans_j.data[r] = ans.data[r * ans.cols + j];
+        }
+        uint64_t entry = pir.Recover(H, ans_j, sks_[j], slots_[j]).toUnsignedLong();
+        if ((entry >> params_.d) == fingerprint_) {
+            value = entry & valueMask;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// Keyword pipeline
+// ============================================================================
+
+bool runKeywordPIR(const std::string& filePath,
+                   uint64_t d,
+                   const std::string& keyColumn,
+                   const std::string& queryKey,
+                   const std::string& columnName,
+                   bool hasHeader,
+                   const PIRConfig& config) {
+    std::cout << "=== Keyword PIR ===" << std::endl;
+    std::vector<std::string> keys;
+    std::unique_ptr<Database> records = loadRecordsWithKeys(filePath, d, keyColumn, keys, columnName, hasHeader);
+    if (!records) {
+        return false;
+    }
+    KeywordParams params;
+    VLHEPIR pir = createKeywordVLHEPIR(keys, *records, d, params, config);
+    std::cout << "Keys: " << filePath << " (column " << keyColumn << "), " 
+              << params.numSlots << " slots, " << params.fingerprintBits << "-bit fingerprints" << std::endl;
+    std::cout << "Database parameters: ";
+    pir.dbParams.print();
+
+    // Offline phase
+    Matrix D = pir.db.packDataInMatrix(pir.dbParams, false);
+    PIRKernels kernels = selectKernels(pir.dbParams);
+    KernelMatrix D_packed = kernels.pack(D);
+    Matrix A = pir.Init();
+    Matrix H = pir.GenerateHint(A, D);
+
+    // Online phase: all candidate slots in one batched scan
+    KeywordPIRClient client;
+    Matrix ct = client.Query(pir, A, params, queryKey);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    Matrix ans = kernels.answer(D_packed, ct);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    std::cout << "Answer time (" << ct.cols << " slot queries, one scan): " << duration.count() << " ms" << std::endl;
+
+    uint64_t value = 0;
+    bool found = client.Recover(pir, H, ans, value);
+
+    // Verification against the file's records, not against the table
+    bool expectedFound = false;
+    uint64_t expectedValue = 0;
+    for (uint64_t record = 0; record < keys.size() && !expectedFound; record++) {
+        if (keys[record] == queryKey) {
+            expectedFound = true;
+            expectedValue = records->data[record].toUnsignedLong();
+        }
+    }
+
+    if (found) {
+        std::cout << "Key '" << queryKey << "': " << value << std::endl;
+    } else {
+        std::cout << "Key '" << queryKey << "': not found" << std::endl;
+    }
+    return found == expectedFound && (!found || value == expectedValue);
+}
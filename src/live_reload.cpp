@@ -0,0 +1,367 @@
+#include "live_reload.h"
+#include "data_loader.h"
+#include "pir_registry.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+// ============================================================================
+// File watch
+// ============================================================================
+
+/**
+ * Files read for path: the path itself, or the CSV / Parquet files of a
+ * directory in name order
+ */
+static bool watchedFiles(const std::string& path, std::vector<std::string>& files) {
+    files.clear();
+    std::error_code error;
+    if (!std::filesystem::is_directory(path, error)) {
+        files.push_back(path);
+        return true;
+    }
+    for (const auto& entry : std::filesystem::directory_iterator(path, error)) {
+        if (entry.is_regular_file() && detectFileFormat(entry.path().string()) != FileFormat::UNKNOWN) {
+            files.push_back(entry.path().string());
+        }
+    }
+    if (error) {
+        std::cerr << "Error: unable to read directory " << path << ": " << error.message() << std::endl;
+        return false;
+    }
+    std::sort(files.begin(), files.end());
+    return true;
+}
+
+FileWatcher::~FileWatcher() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool FileWatcher::open(const std::string& path) {
+    path_ = path;
+    std::error_code error;
+    bool directory = std::filesystem::is_directory(path, error);
+    if (!directory && !std::filesystem::exists(path, error)) {
+        std::cerr << "Error: unable to watch " << path << ": no such file or directory" << std::endl;
+        return false;
+    }
+    lastFingerprint_ = fingerprint();
+#ifdef __linux__
+    // A file is watched through its directory, so that a writer replacing
+    // it (write to a temporary, rename over it) is still seen
+    std::filesystem::path target(path);
+    std::string watched = directory ? path : target.parent_path().string();
+    name_ = directory ? "" : target.filename().string();
+    if (watched.empty()) {
+        watched = ".";
+    }
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ >= 0 && inotify_add_watch(fd_, watched.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+#endif
+    return true;
+}
+
+uint64_t FileWatcher::fingerprint() const {
+    std::vector<std::string> files;
+    watchedFiles(path_, files);
+    uint64_t hash = files.size();
+    for (const std::string& file : files) {
+        struct stat info;
+        if (stat(file.c_str(), &info) != 0) continue;
+        hash = hash * 1000003 ^ uint64_t(info.st_size);
+        hash = hash * 1000003 ^ uint64_t(info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec);
+    }
+    return hash;
+}
+
+bool FileWatcher::wait(int timeoutMs) {
+#ifdef __linux__
+    if (fd_ >= 0) {
+        struct pollfd ready = {fd_, POLLIN, 0};
+        if (::poll(&ready, 1, timeoutMs) <= 0) {
+            return false;
+        }
+        // Drain every pending event, keeping those about the watched name
+        alignas(struct inotify_event) char buffer[4096];
+        bool changed = false;
+        ssize_t bytes;
+        while ((bytes = read(fd_, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + bytes;) {
+                const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+                changed = changed || name_.empty() || (event->len > 0 && name_ == event->name);
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        return changed;
+    }
+#endif
+    static const int kPollMs = 50;
+    for (int waited = 0; waited < timeoutMs; waited += kPollMs) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::min(kPollMs, timeoutMs - waited)));
+        uint64_t current = fingerprint();
+        if (current != lastFingerprint_) {
+            lastFingerprint_ = current;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// Append ingest
+// ============================================================================
+
+bool AppendIngestor::poll(std::vector<uint64_t>& values) {
+    values.clear();
+    std::vector<std::string> files;
+    if (!watchedFiles(path_, files)) {
+        return false;
+    }
+    for (const std::string& file : files) {
+        if (!pollFile(file, values)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AppendIngestor::pollFile(const std::string& file, std::vector<uint64_t>& values) {
+    struct stat info;
+    if (stat(file.c_str(), &info) != 0) {
+        return true;  // removed meanwhile
+    }
+    Source& source = sources_[file];
+    auto modified = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::seconds(info.st_mtim.tv_sec) + std::chrono::nanoseconds(info.st_mtim.tv_nsec)));
+
+    std::vector<std::vector<uint64_t>> columns;
+    uint64_t before = values.size();
+    if (detectFileFormat(file) == FileFormat::PARQUET) {
+        if (uint64_t(info.st_size) == source.offset) {
+            return true;  // unchanged since the last read
+        }
+        if (!readParquetColumns(columns, file, {column_})) {
+            return false;
+        }
+        if (columns[0].size() < source.rows) {
+            std::cerr << "Error: " << file << " lost rows (" << source.rows << " -> " << columns[0].size()
+                      << "), only appends can be served" << std::endl;
+            return false;
+        }
+        values.insert(values.end(), columns[0].begin() + source.rows, columns[0].end());
+        source.rows = columns[0].size();
+        source.offset = info.st_size;
+    } else {
+        if (uint64_t(info.st_size) < source.offset) {
+            std::cerr << "Error: " << file << " was truncated, only appends can be served" << std::endl;
+            return false;
+        }
+        if (!readCSVColumnsFrom(columns, file, {column_}, hasHeader_, source.offset, source.lines)) {
+            return false;
+        }
+        values.insert(values.end(), columns[0].begin(), columns[0].end());
+    }
+    if (values.size() > before) {
+        lastModified_ = std::max(lastModified_, modified);
+    }
+    return true;
+}
+
+// ============================================================================
+// Watched server
+// ============================================================================
+
+void ReloadMetrics::print(std::ostream& out) const {
+    uint64_t reloads = incremental + full;
+    out << "=== Reload metrics ===" << std::endl;
+    out << "Reloads: " << reloads << " (" << incremental << " incremental, " << full << " full), "
+        << rows << " rows ingested" << std::endl;
+    out << std::fixed << std::setprecision(3);
+    if (incremental) {
+        out << "Incremental update (copy of D and H + changed columns): avg " << incrementalMs / incremental
+            << " ms, max " << maxIncrementalMs << " ms" << std::endl;
+    }
+    if (full) {
+        out << "Full rebuild (background): avg " << fullMs / full << " ms, max " << maxFullMs << " ms, "
+            << rowsDuringRebuild << " rows read meanwhile" << std::endl;
+    }
+    if (reloads) {
+        out << "Freshness lag: avg " << totalLagMs / reloads << " ms, max " << maxLagMs << " ms" << std::endl;
+    }
+    out.unsetf(std::ios::fixed);
+    out << std::setprecision(6);
+}
+
+bool runWatchedPIR(const std::string& path, const std::string& column, uint64_t queryIndex,
+                   double seconds, double reserve, bool hasHeader, const PIRConfig& config) {
+    std::cout << "=== Watched server ===" << std::endl;
+    AppendIngestor ingestor(path, column, hasHeader);
+    std::vector<uint64_t> values;
+    if (!ingestor.poll(values)) {
+        return false;
+    }
+    if (values.empty()) {
+        std::cerr << "Error: no data found in " << path << std::endl;
+        return false;
+    }
+    if (queryIndex >= values.size()) {
+        std::cerr << "Error: query index " << queryIndex << " out of bounds (max: " << (values.size() - 1) << ")" << std::endl;
+        return false;
+    }
+    if (!(reserve >= 0 && reserve <= MAX_RESERVE)) {
+        std::cerr << "Error: reserve must be in [0, " << MAX_RESERVE << "], got " << reserve << std::endl;
+        return false;
+    }
+
+    // The matrix is built for size * (1 + reserve) entries, the slots past
+    // the data stay zero until appends fill them
+    PIRRegistry registry;
+    uint64_t size = values.size();
+    uint64_t N = size + uint64_t(size * reserve);
+    uint64_t d = calculateBitSize(*std::max_element(values.begin(), values.end()));
+    std::unique_ptr<VLHEPIR> pir(new VLHEPIR(N, d, config.allowTrivial, config.verbose, config.simplePIR,
+                                             false, config.batchSize, config.honestHint));
+    if (!pir->db.alloc) {
+        pir->db.data = (entry_t*)malloc(N * sizeof(entry_t));
+        pir->db.alloc = true;
+    }
+    memset(pir->db.data, 0, N * sizeof(entry_t));
+    selectKernels(d, 0).load(pir->db, 0, values.data(), size);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    registry.Register(column, std::move(pir), size, reserve);
+    std::chrono::duration<double, std::milli> offline = std::chrono::high_resolution_clock::now() - start_time;
+    std::cout << "Offline phase: " << offline.count() << " ms (N = " << size << ", capacity " << N
+              << ", d = " << d << ")" << std::endl;
+
+    FileWatcher watcher;
+    if (!watcher.open(path)) {
+        return false;
+    }
+    std::cout << "Watching " << path << " (" << watcher.backend() << ")";
+    if (seconds > 0) {
+        std::cout << " for " << seconds << " s";
+    }
+    std::cout << std::endl;
+
+    // The client queries queryIndex and the newest entry of whichever epoch
+    // is current, decoding with the hint of that epoch. Indices are bounded
+    // by the entries in use of the snapshot, not by its capacity
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> served{0};
+    std::atomic<uint64_t> mismatches{0};
+    std::thread client([&]() {
+        while (!stop) {
+            std::shared_ptr<const HostedDatabase> snapshot = registry.Find(column);
+            for (uint64_t index : {queryIndex, snapshot->size - 1}) {
+                if (index >= snapshot->size) continue;
+                auto ct_sk = snapshot->pir->Query(*snapshot->A, index);
+                Matrix ans;
+                registry.Answer(*snapshot, std::get<0>(ct_sk), ans);
+                entry_t result = snapshot->pir->Recover(snapshot->H, ans, std::get<1>(ct_sk), index);
+                mismatches += (result == snapshot->pir->db.getDataAtIndex(index)) ? 0 : 1;
+                served++;
+            }
+        }
+    });
+
+    // A full rebuild runs in the background (ExtendAsync): rows appended
+    // meanwhile are read into a backlog, published once it is done
+    static const int kWaitMs = 200;
+    static const int kRebuildWaitMs = 10;
+    struct Reload {
+        std::shared_future<uint64_t> epoch;
+        uint64_t rows = 0;
+        bool incremental = false;
+        std::chrono::high_resolution_clock::time_point start;
+        std::chrono::system_clock::time_point modified;
+    };
+    ReloadMetrics metrics;
+    Reload running;
+    std::vector<uint64_t> backlog;
+    std::chrono::system_clock::time_point backlogModified;
+    bool ok = true;
+
+    auto finish = [&](Reload& reload) {
+        uint64_t epoch = reload.epoch.get();
+        reload.epoch = std::shared_future<uint64_t>();
+        std::chrono::duration<double, std::milli> build = std::chrono::high_resolution_clock::now() - reload.start;
+        std::chrono::duration<double, std::milli> lag = std::chrono::system_clock::now() - reload.modified;
+        if (epoch == 0) {
+            return false;
+        }
+        size += reload.rows;
+        N = registry.Find(column)->pir->N;
+        metrics.rows += reload.rows;
+        if (reload.incremental) {
+            metrics.incremental++;
+            metrics.incrementalMs += build.count();
+            metrics.maxIncrementalMs = std::max(metrics.maxIncrementalMs, build.count());
+        } else {
+            metrics.full++;
+            metrics.fullMs += build.count();
+            metrics.maxFullMs = std::max(metrics.maxFullMs, build.count());
+        }
+        metrics.totalLagMs += std::max(0.0, lag.count());
+        metrics.maxLagMs = std::max(metrics.maxLagMs, lag.count());
+        std::cout << "Epoch " << epoch << ": +" << reload.rows << " rows (N = " << size << ", capacity " << N << "), "
+                  << (reload.incremental ? "incremental" : "full rebuild") << " in " << build.count()
+                  << " ms, lag " << lag.count() << " ms" << std::endl;
+        return true;
+    };
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    while (ok && (seconds <= 0 || std::chrono::steady_clock::now() < deadline)) {
+        bool rebuilding = running.epoch.valid();
+        bool changed = watcher.wait(rebuilding ? kRebuildWaitMs : kWaitMs);
+        if (rebuilding && running.epoch.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            ok = finish(running);
+            rebuilding = false;
+        }
+        if (ok && changed) {
+            ok = ingestor.poll(values);
+            if (!values.empty()) {
+                metrics.rowsDuringRebuild += rebuilding ? values.size() : 0;
+                backlog.insert(backlog.end(), values.begin(), values.end());
+                backlogModified = ingestor.lastModified();
+            }
+        }
+        if (!ok || rebuilding || backlog.empty()) {
+            continue;  // no complete row yet, or waiting for the rebuild
+        }
+        running.rows = backlog.size();
+        running.modified = backlogModified;
+        running.start = std::chrono::high_resolution_clock::now();
+        running.epoch = registry.ExtendAsync(column, backlog, config, &running.incremental);
+        backlog.clear();
+        if (running.incremental) {
+            ok = finish(running);
+        }
+    }
+    if (running.epoch.valid()) {
+        ok = finish(running) && ok;
+    }
+    stop = true;
+    client.join();
+
+    metrics.print(std::cout);
+    std::cout << "Client: " << served << " queries, " << mismatches << " wrong answer(s)" << std::endl;
+    registry.PrintMetrics(std::cout);
+    return ok && mismatches == 0;
+}
@@ -1,8 +1,29 @@
+#include "async_reader.h"
+#include "batch_pir.h"
 #include "data_loader.h"
+#include "engine_compare.h"
+#include "engine_selector.h"
+#include "fused_pir.h"
+#include "hint_bench.h"
+#include "hint_checkpoint.h"
+#include "distributed_hint.h"
+#include "keyword_pir.h"
+#include "live_reload.h"
+#include "partitioned_pir.h"
+#include "pir_registry.h"
+#include "recursive_pir.h"
+#include "two_server_pir.h"
+#include "pir_client.h"
+#include "pir_kernels.h"
+#include "range_pir.h"
+#include "sharded_pir.h"
+#include "streaming_pir.h"
 #include <openssl/sha.h>
 #include <iostream>
 #include <iomanip>
 #include <chrono>
+#include <sstream>
+#include <vector>
 
 const bool verify = false;
 
@@ -88,31 +109,163 @@ std::pair<uint64_t, uint64_t> parseN(const std::string& str) {
     }
 }
 
+/**
+ * Prints the command line help (defaultD: the default --d)
+ */
+static void printUsage(const char* program, uint64_t defaultD) {
+    std::cerr << "Usage: " << program << " <data_file> [query_index] [column_name] [--d <d|auto>]" << std::endl;
+    std::cerr << "       [--group-by <key_column> [--index-map <file>]] [--batch <i1,i2,...>]" << std::endl;
+    std::cerr << "       [--keyword <key_column> --key <record_id>] [--range <lo,hi>]" << std::endl;
+    std::cerr << "       [--columns <name[:d],name[:d],...>] [--fused <column,column,...>]" << std::endl;
+    std::cerr << "       [--tenants <column,column,...> [--reload]] [--partition-by <column>]" << std::endl;
+    std::cerr << "   OR: " << program << " <directory> [query_index] --partitioned [--d <d|auto>]" << std::endl;
+    std::cerr << "   OR: " << program << " <file|directory> [query_index] [column_name] --watch <seconds>" << std::endl;
+    std::cerr << "       [--reserve <fraction>]" << std::endl;
+    std::cerr << "   OR: " << program << " --generate <N> <d> [query_index] [--two-server] [--recursive] [--compare]" << std::endl;
+    std::cerr << "   (both) [--stream <file> [--stream-block <MiB>]] [--shards <k>]" << std::endl;
+    std::cerr << "          [--io-depth <n>] [--io-buffer <KiB>] [--direct] [--no-io-uring]" << std::endl;
+    std::cerr << "          [--hint-checkpoint <file> [--hint-tile <rows>] [--checkpoint-every <s>]]" << std::endl;
+    std::cerr << "          [--hint-threads <n>] [--hint-bench] [--hint-workers <k>]" << std::endl;
+    std::cerr << "   (both) [--engine <auto|trivial|simplepir|vlhepir|honest-hint>] [--queries <Q>]" << std::endl;
+    std::cerr << "          [--bandwidth <Mbit/s>] [--latency <ms>] [--trust-hint] [--allow-unverified]" << std::endl;
+    std::cerr << "          [--report <file>]" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  <data_file>: path to CSV or Parquet file containing a column of numeric values" << std::endl;
+    std::cerr << "       (- reads CSV from standard input, e.g. zcat audit.csv.gz | pir -)" << std::endl;
+    std::cerr << "  --generate: generate a random database of N elements with d bits" << std::endl;
+    std::cerr << "  <N>: number of elements in the database" << std::endl;
+    std::cerr << "       Can be a number (e.g., 1024) or power of 2 (e.g., 2^10, 2**10)" << std::endl;
+    std::cerr << "  <d>: number of bits per element (values in [0, 2^d-1])" << std::endl;
+    std::cerr << "  query_index: index of element to retrieve (default: 0)" << std::endl;
+    std::cerr << "  column_name: column name (optional, for Parquet only)" << std::endl;
+    std::cerr << "  --d: bits per element for files (default: " << defaultD << ")" << std::endl;
+    std::cerr << "       auto infers d from the column's maximum value" << std::endl;
+    std::cerr << "  --group-by: place records sharing this key in the same database column" << std::endl;
+    std::cerr << "       (query_index is then a record index of the input file)" << std::endl;
+    std::cerr << "  --index-map: where to publish the record -> position map (default: index_map.csv)" << std::endl;
+    std::cerr << "  --batch: retrieve several indices at once with cuckoo-hashed buckets" << std::endl;
+    std::cerr << "  --keyword: retrieve by record identifier (key_column) instead of index" << std::endl;
+    std::cerr << "  --range: sum of the values between indices lo and hi (inclusive)" << std::endl;
+    std::cerr << "  --columns: retrieve whole records, the listed columns are concatenated" << std::endl;
+    std::cerr << "       into one entry (d per column, inferred when omitted; 64 bits at most)" << std::endl;
+    std::cerr << "  --fused: one database per column, all answered from one query in one pass" << std::endl;
+    std::cerr << "  --tenants: host one database per column (own d) in one server, queried by name" << std::endl;
+    std::cerr << "  --reload: with --tenants, load the file again as the next epoch while queries" << std::endl;
+    std::cerr << "       keep being served, then swap" << std::endl;
+    std::cerr << "  --partition-by: one database per value of this column (e.g. the day)," << std::endl;
+    std::cerr << "       a query only scans the partition holding the record" << std::endl;
+    std::cerr << "  --partitioned: one database per file of <directory>, records numbered across files" << std::endl;
+    std::cerr << "  --watch: serve the column and ingest the rows appended to the file (or to the" << std::endl;
+    std::cerr << "       files of the directory) as new epochs, updating the hint in place while" << std::endl;
+    std::cerr << "       the shape allows; 0 seconds runs until interrupted" << std::endl;
+    std::cerr << "  --reserve: with --watch, spare capacity for appends as a fraction of N" << std::endl;
+    std::cerr << "       (default 0); only appends past it reshape the matrix" << std::endl;
+    std::cerr << "  --two-server: also answer with the two-server DPF engine (two local server" << std::endl;
+    std::cerr << "       processes) and compare with VLHEPIR" << std::endl;
+    std::cerr << "  --recursive: two-level PIR (the answer is queried again), with a plan of" << std::endl;
+    std::cerr << "       when recursion wins on communication" << std::endl;
+    std::cerr << "  --compare: run the whole pipeline under every simplePIR / honestHint" << std::endl;
+    std::cerr << "       combination on the same data (table, and JSON to --report or" << std::endl;
+    std::cerr << "       engine_comparison.json)" << std::endl;
+    std::cerr << "  --stream: keep the packed matrix in <file> and answer by streaming it" << std::endl;
+    std::cerr << "       (two buffers of --stream-block MiB, default 64), vs the disk bandwidth" << std::endl;
+    std::cerr << "  --shards: answer through 1, 2, 4, ... k server processes holding one row" << std::endl;
+    std::cerr << "       slice each, merging their partial answers" << std::endl;
+    std::cerr << "  --io-depth, --io-buffer: reads in flight and buffer size of the CSV and" << std::endl;
+    std::cerr << "       --stream readers (default: 4, 1024 KiB; --stream uses --stream-block)" << std::endl;
+    std::cerr << "  --direct: O_DIRECT reads; --no-io-uring: pread thread instead of io_uring" << std::endl;
+    std::cerr << "  --hint-checkpoint: generate the hint tile by tile (--hint-tile rows, default" << std::endl;
+    std::cerr << "       4096), saved to <file> every --checkpoint-every seconds (default 30);" << std::endl;
+    std::cerr << "       an interrupted run resumes from the file" << std::endl;
+    std::cerr << "  --hint-threads: threads of the blocked hint kernel (default: all cores)" << std::endl;
+    std::cerr << "  --hint-workers: split the hint rows across k worker processes (--hint-threads" << std::endl;
+    std::cerr << "       each), stitch and check their blocks" << std::endl;
+    std::cerr << "  --hint-bench: time the hint kernel on 1, 2, 4, ... --hint-threads vs GenerateHint" << std::endl;
+    std::cerr << "  --engine: PIR engine; auto estimates all of them on this database and" << std::endl;
+    std::cerr << "       workload and picks the cheapest (default: vlhepir, no estimation)" << std::endl;
+    std::cerr << "  --queries, --bandwidth, --latency: workload for --engine (default: 1, 100, 20)" << std::endl;
+    std::cerr << "  --trust-hint: allow honest-hint; --allow-unverified: allow simplepir" << std::endl;
+    std::cerr << "  --report: write the engine estimates and reasoning (JSON if *.json)" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "Examples:" << std::endl;
+    std::cerr << "  " << program << " data/test.csv 5" << std::endl;
+    std::cerr << "  " << program << " data/scores.csv 5 --d 8" << std::endl;
+    std::cerr << "  " << program << " data/audit.csv 5 --group-by account" << std::endl;
+    std::cerr << "  " << program << " data/test.csv --batch 3,17,42,99" << std::endl;
+    std::cerr << "  " << program << " data/audit.csv --keyword record_id --key TX-00042" << std::endl;
+    std::cerr << "  " << program << " data/flags.csv --range 100,2000" << std::endl;
+    std::cerr << "  " << program << " data/audit.csv 5 --columns score:8,flag:1,region" << std::endl;
+    std::cerr << "  " << program << " data/audit.csv 5 --fused score,flag,region --d 8" << std::endl;
+    std::cerr << "  " << program << " data/audit.csv 5 --tenants score,flag,region" << std::endl;
+    std::cerr << "  " << program << " data/audit.csv 5 --partition-by day" << std::endl;
+    std::cerr << "  " << program << " data/days/ 5 --partitioned" << std::endl;
+    std::cerr << "  " << program << " --generate 1000 1 5" << std::endl;
+    std::cerr << "  " << program << " --generate 2^10 1 5" << std::endl;
+    std::cerr << "  " << program << " --generate 2**20 8 42" << std::endl;
+    std::cerr << "  " << program << " --generate 2^24 8 42 --two-server" << std::endl;
+    std::cerr << "  " << program << " --generate 2^26 8 42 --recursive" << std::endl;
+    std::cerr << "  " << program << " data/scores.csv 5 --d 8 --engine auto --queries 1000" << std::endl;
+    std::cerr << "  " << program << " --generate 2^20 8 42 --compare" << std::endl;
+    std::cerr << "  " << program << " --generate 2^30 8 42 --stream /data/packed.bin" << std::endl;
+}
+
+/**
+ * Parses the value of a numeric option: the whole string must be a number
+ * in [lo, hi]. Prints an error naming the option and returns false otherwise
+ */
+static bool parseOptionValue(const std::string& option, const std::string& value, uint64_t& out,
+                             uint64_t lo = 0, uint64_t hi = UINT64_MAX) {
+    size_t end = 0;
+    uint64_t parsed = 0;
+    bool ok = !value.empty() && value[0] >= '0' && value[0] <= '9';
+    try {
+        parsed = ok ? std::stoull(value, &end) : 0;
+    } catch (const std::exception&) {
+        ok = false;
+    }
+    if (!ok || end != value.size() || parsed < lo || parsed > hi) {
+        std::cerr << "Error: " << option << " expects an integer ";
+        if (hi == UINT64_MAX) {
+            std::cerr << ">= " << lo;
+        } else {
+            std::cerr << "in [" << lo << ", " << hi << "]";
+        }
+        std::cerr << ", got '" << value << "'" << std::endl;
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+static bool parseOptionValue(const std::string& option, const std::string& value, double& out,
+                             double lo, double hi) {
+    size_t end = 0;
+    double parsed = 0;
+    bool ok = !value.empty();
+    try {
+        parsed = ok ? std::stod(value, &end) : 0;
+    } catch (const std::exception&) {
+        ok = false;
+    }
+    if (!ok || end != value.size() || !(parsed >= lo && parsed <= hi)) {
+        std::cerr << "Error: " << option << " expects a number in [" << lo << ", " << hi
+                  << "], got '" << value << "'" << std::endl;
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     // ========================================================================
     // 1. Configuration
     // ========================================================================
-    // Database precision in bits
+    // Default database precision in bits for files (see --d)
     const uint64_t d = 1;
     
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <data_file> [query_index] [column_name]" << std::endl;
-        std::cerr << "   OR: " << argv[0] << " --generate <N> <d> [query_index]" << std::endl;
-        std::cerr << std::endl;
-        std::cerr << "Options:" << std::endl;
-        std::cerr << "  <data_file>: path to CSV or Parquet file containing a column of numeric values" << std::endl;
-        std::cerr << "  --generate: generate a random database of N elements with d bits" << std::endl;
-        std::cerr << "  <N>: number of elements in the database" << std::endl;
-        std::cerr << "       Can be a number (e.g., 1024) or power of 2 (e.g., 2^10, 2**10)" << std::endl;
-        std::cerr << "  <d>: number of bits per element (values in [0, 2^d-1])" << std::endl;
-        std::cerr << "  query_index: index of element to retrieve (default: 0)" << std::endl;
-        std::cerr << "  column_name: column name (optional, for Parquet only)" << std::endl;
-        std::cerr << std::endl;
-        std::cerr << "Examples:" << std::endl;
-        std::cerr << "  " << argv[0] << " data/test.csv 5" << std::endl;
-        std::cerr << "  " << argv[0] << " --generate 1000 1 5" << std::endl;
-        std::cerr << "  " << argv[0] << " --generate 2^10 1 5" << std::endl;
-        std::cerr << "  " << argv[0] << " --generate 2**20 8 42" << std::endl;
+        printUsage(argv[0], d);
         return 1;
     }
     
@@ -124,6 +277,77 @@ int main(int argc, char* argv[]) {
     uint64_t queryIndex = 0;
     std::string dataFile;
     std::string columnName = "";
+    std::string groupBy = "";
+    std::string indexMapFile = "index_map.csv";
+    std::vector<uint64_t> batchIndices;
+    std::string keywordColumn = "";
+    std::string queryKey = "";
+    bool rangeQuery = false;
+    uint64_t rangeLo = 0, rangeHi = 0;
+    RecordSchema recordSchema;
+    std::vector<std::string> fusedColumns;
+    std::vector<std::string> tenantColumns;
+    std::string partitionBy = "";
+    bool partitioned = false;
+    bool twoServer = false;
+    bool recursive = false;
+    bool compare = false;
+    bool reload = false;
+    double watchSeconds = -1;
+    double reserve = 0;
+    std::string engineArg = "";
+    std::string reportFile = "";
+    std::string streamFile = "";
+    uint64_t streamBlockMiB = 64;
+    uint64_t numShards = 0;
+    std::string hintCheckpoint = "";
+    HintTiling hintTiling;
+    uint64_t hintThreads = 0;
+    bool hintBench = false;
+    uint64_t hintWorkers = 0;
+    Workload workload;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        twoServer = twoServer || (arg == "--two-server");
+        recursive = recursive || (arg == "--recursive");
+        compare = compare || (arg == "--compare");
+        reload = reload || (arg == "--reload");
+        hintBench = hintBench || (arg == "--hint-bench");
+        workload.trustHint = workload.trustHint || (arg == "--trust-hint");
+        workload.requireVerifiable = workload.requireVerifiable && (arg != "--allow-unverified");
+        asyncReadDefaults().direct = asyncReadDefaults().direct || (arg == "--direct");
+        asyncReadDefaults().useIoUring = asyncReadDefaults().useIoUring && (arg != "--no-io-uring");
+        bool parsed = true;
+        if (i + 1 < argc) {
+            const std::string value = argv[i + 1];
+            if (arg == "--engine") engineArg = argv[i + 1];
+            if (arg == "--report") reportFile = argv[i + 1];
+            if (arg == "--stream") streamFile = argv[i + 1];
+            if (arg == "--stream-block") parsed = parseOptionValue(arg, value, streamBlockMiB, 1, 1ULL << 20);
+            if (arg == "--shards") parsed = parseOptionValue(arg, value, numShards, 1, 1024);
+            if (arg == "--io-depth") parsed = parseOptionValue(arg, value, asyncReadDefaults().queueDepth, 1, 4096);
+            if (arg == "--hint-checkpoint") hintCheckpoint = argv[i + 1];
+            if (arg == "--hint-tile") parsed = parseOptionValue(arg, value, hintTiling.tileRows, 1);
+            if (arg == "--checkpoint-every") parsed = parseOptionValue(arg, value, hintTiling.checkpointSeconds, 0, 1e9);
+            if (arg == "--hint-workers") parsed = parseOptionValue(arg, value, hintWorkers, 1, 1024);
+            if (arg == "--hint-threads") {
+                parsed = parseOptionValue(arg, value, hintThreads, 0, 4096);
+                hintTiling.threads = hintThreads;
+            }
+            if (arg == "--io-buffer") {
+                uint64_t kib = 0;
+                parsed = parseOptionValue(arg, value, kib, 1, 1ULL << 20);
+                asyncReadDefaults().bufferBytes = parsed ? kib << 10 : asyncReadDefaults().bufferBytes;
+            }
+            if (arg == "--queries") parsed = parseOptionValue(arg, value, workload.queries, 1);
+            if (arg == "--bandwidth") parsed = parseOptionValue(arg, value, workload.bandwidthMbps, 1e-6, 1e9);
+            if (arg == "--latency") parsed = parseOptionValue(arg, value, workload.latencyMs, 0, 1e9);
+        }
+        if (!parsed) {
+            printUsage(argv[0], d);
+            return 1;
+        }
+    }
     
     // Check if --generate option is used
     if (std::string(argv[1]) == "--generate" || std::string(argv[1]) == "-g") {
@@ -145,9 +369,139 @@ int main(int argc, char* argv[]) {
         d_value = std::stoull(argv[3]);
         queryIndex = (argc > 4) ? std::stoull(argv[4]) : 0;
     } else {
-        dataFile = argv[1];
-        queryIndex = (argc > 2) ? std::stoull(argv[2]) : 0;
-        columnName = (argc > 3) ? argv[3] : "";
+        // Options may appear anywhere after the data file
+        std::vector<std::string> positional;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--d" || arg == "-d") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --d requires a value (number of bits or 'auto')" << std::endl;
+                    return 1;
+                }
+                std::string value = argv[++i];
+                if (value == "auto") {
+                    d_value = 0;
+                } else if (!parseOptionValue(arg, value, d_value, 1, 64)) {
+                    return 1;
+                }
+            } else if ((arg == "--group-by" || arg == "--index-map") && i + 1 < argc) {
+                (arg == "--group-by" ? groupBy : indexMapFile) = argv[++i];
+            } else if ((arg == "--keyword" || arg == "--key") && i + 1 < argc) {
+                (arg == "--keyword" ? keywordColumn : queryKey) = argv[++i];
+            } else if (arg == "--range" && i + 1 < argc) {
+                std::string range = argv[++i];
+                size_t comma = range.find(',');
+                if (comma == std::string::npos) {
+                    std::cerr << "Error: --range expects lo,hi" << std::endl;
+                    return 1;
+                }
+                rangeQuery = true;
+                if (!parseOptionValue(arg, range.substr(0, comma), rangeLo) ||
+                    !parseOptionValue(arg, range.substr(comma + 1), rangeHi)) {
+                    return 1;
+                }
+            } else if (arg == "--columns" && i + 1 < argc) {
+                if (!RecordSchema::parse(argv[++i], recordSchema)) {
+                    std::cerr << "Error: --columns expects name[:d],name[:d],..." << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--partition-by" && i + 1 < argc) {
+                partitionBy = argv[++i];
+                partitioned = true;
+            } else if (arg == "--partitioned") {
+                partitioned = true;
+            } else if (arg == "--reload") {
+                // Parsed above
+            } else if (arg == "--watch" && i + 1 < argc) {
+                if (!parseOptionValue(arg, argv[++i], watchSeconds, 0, 1e9)) {
+                    printUsage(argv[0], d);
+                    return 1;
+                }
+            } else if (arg == "--reserve" && i + 1 < argc) {
+                if (!parseOptionValue(arg, argv[++i], reserve, 0, MAX_RESERVE)) {
+                    printUsage(argv[0], d);
+                    return 1;
+                }
+            } else if (arg == "--two-server" || arg == "--recursive" || arg == "--compare" ||
+                       arg == "--trust-hint" || arg == "--allow-unverified" ||
+                       arg == "--direct" || arg == "--no-io-uring" || arg == "--hint-bench") {
+                // Parsed above, also valid with --generate
+            } else if ((arg == "--engine" || arg == "--report" || arg == "--queries" ||
+                        arg == "--bandwidth" || arg == "--latency" || arg == "--stream" ||
+                        arg == "--stream-block" || arg == "--shards" || arg == "--io-depth" || arg == "--io-buffer" ||
+                        arg == "--hint-checkpoint" || arg == "--hint-tile" || arg == "--checkpoint-every" ||
+                        arg == "--hint-threads" || arg == "--hint-workers") && i + 1 < argc) {
+                i++;  // Parsed above, also valid with --generate
+            } else if ((arg == "--fused" || arg == "--tenants") && i + 1 < argc) {
+                std::vector<std::string>& list = (arg == "--fused") ? fusedColumns : tenantColumns;
+                std::stringstream items(argv[++i]);
+                std::string item;
+                while (std::getline(items, item, ',')) {
+                    list.push_back(item);
+                }
+            } else if (arg == "--batch" && i + 1 < argc) {
+                std::stringstream list(argv[++i]);
+                std::string item;
+                while (std::getline(list, item, ',')) {
+                    uint64_t index = 0;
+                    if (!parseOptionValue(arg, item, index)) {
+                        return 1;
+                    }
+                    batchIndices.push_back(index);
+                }
+            } else {
+                positional.push_back(arg);
+            }
+        }
+        if (positional.empty()) {
+            std::cerr << "Error: missing data file" << std::endl;
+            return 1;
+        }
+        dataFile = positional[0];
+        queryIndex = (positional.size() > 1) ? std::stoull(positional[1]) : 0;
+        columnName = (positional.size() > 2) ? positional[2] : "";
+    }
+    
+    // Standard input can only be read once, by the loader itself
+    bool fromStdin = !useRandomGeneration && dataFile == "-";
+    if (fromStdin && (partitioned || watchSeconds >= 0 || !keywordColumn.empty() || !fusedColumns.empty() ||
+                      !tenantColumns.empty() || !groupBy.empty() || !recordSchema.fields.empty() ||
+                      !engineArg.empty())) {
+        std::cerr << "Error: data from standard input ('-') only supports single-column queries" << std::endl;
+        return 1;
+    }
+    
+    if (partitioned && !useRandomGeneration) {
+        // Partitions come from a column or from the files of a directory
+        std::cout << "========================================" << std::endl;
+        std::cout << "  VLHEPIR with partitions" << std::endl;
+        std::cout << "========================================" << std::endl;
+        std::cout << "Source: " << dataFile << std::endl;
+        if (!partitionBy.empty()) {
+            std::cout << "Partitioned by: " << partitionBy << std::endl;
+        }
+        std::cout << "Query index: " << queryIndex << std::endl;
+        std::cout << std::endl;
+        bool ok = runPartitionedPIR(dataFile, d_value, partitionBy, queryIndex, columnName);
+        std::cout << std::endl;
+        std::cout << (ok ? "✓ Success! Recovered value matches expected value." 
+                         : "✗ Error! Recovered value does not match.") << std::endl;
+        return ok ? 0 : 1;
+    }
+    
+    if (watchSeconds >= 0 && !useRandomGeneration) {
+        // Appends to the input become new epochs while queries are served
+        std::cout << "========================================" << std::endl;
+        std::cout << "  VLHEPIR with live reload" << std::endl;
+        std::cout << "========================================" << std::endl;
+        std::cout << "Source: " << dataFile << std::endl;
+        std::cout << "Query index: " << queryIndex << std::endl;
+        std::cout << std::endl;
+        bool ok = runWatchedPIR(dataFile, columnName.empty() ? "0" : columnName, queryIndex, watchSeconds, reserve);
+        std::cout << std::endl;
+        std::cout << (ok ? "✓ Every epoch answered correctly." 
+                         : "✗ Error! An answer does not match its epoch.") << std::endl;
+        return ok ? 0 : 1;
     }
     
     std::cout << "========================================" << std::endl;
@@ -164,7 +518,7 @@ int main(int argc, char* argv[]) {
         std::cout << "Query index: " << queryIndex << std::endl;
     } else {
         // Detect file format
-        FileFormat format = detectFileFormat(dataFile);
+        FileFormat format = fromStdin ? FileFormat::CSV : detectFileFormat(dataFile);
         
         if (format == FileFormat::UNKNOWN) {
             std::cerr << "Error: unrecognized file format. Supported formats: .csv, .parquet" << std::endl;
@@ -173,19 +527,96 @@ int main(int argc, char* argv[]) {
         
         std::cout << "  VLHEPIR with " << (format == FileFormat::PARQUET ? "Parquet" : "CSV") << std::endl;
         std::cout << "========================================" << std::endl;
-        std::cout << "File: " << dataFile << std::endl;
+        std::cout << "File: " << (fromStdin ? "standard input (streamed)" : dataFile) << std::endl;
         std::cout << "Format: " << (format == FileFormat::PARQUET ? "Parquet" : "CSV") << std::endl;
-        std::cout << "Precision (d): " << d << " bits" << std::endl;
+        if (d_value == 0) {
+            std::cout << "Precision (d): auto (inferred from the column's maximum)" << std::endl;
+        } else {
+            std::cout << "Precision (d): " << d_value << " bits" << std::endl;
+        }
         std::cout << "Query index: " << queryIndex << std::endl;
         if (!columnName.empty()) {
             std::cout << "Column: " << columnName << std::endl;
         }
+        if (!groupBy.empty()) {
+            std::cout << "Grouped by: " << groupBy << std::endl;
+        }
+        if (!recordSchema.fields.empty()) {
+            std::cout << "Record columns: " << recordSchema.fields.size() << std::endl;
+        }
     }
     std::cout << std::endl;
     
+    if (!keywordColumn.empty()) {
+        // Keyword mode replaces the index-based pipeline below
+        bool ok = runKeywordPIR(dataFile, d_value, keywordColumn, queryKey, columnName);
+        std::cout << std::endl;
+        std::cout << (ok ? "✓ Keyword lookup matches the database." 
+                         : "✗ Error! Keyword lookup does not match the database.") << std::endl;
+        return ok ? 0 : 1;
+    }
+    
+    if (!fusedColumns.empty()) {
+        bool ok = runFusedPIR(dataFile, fusedColumns, d_value, queryIndex);
+        std::cout << std::endl;
+        std::cout << (ok ? "✓ All fused answers match their databases." 
+                         : "✗ Error! A fused answer does not match its database.") << std::endl;
+        return ok ? 0 : 1;
+    }
+    
+    if (!tenantColumns.empty()) {
+        bool ok = runRegistryPIR(dataFile, tenantColumns, queryIndex, true, PIRConfig(), reload);
+        std::cout << std::endl;
+        std::cout << (ok ? "✓ All databases answered correctly." 
+                         : "✗ Error! A database answer does not match.") << std::endl;
+        return ok ? 0 : 1;
+    }
+    
+    // Engine flags, estimated on this database when --engine is given
+    PIRConfig config;
+    Engine engine = Engine::VLHEPIR;
+    if (!engineArg.empty()) {
+        bool isAuto = false;
+        if (!parseEngine(engineArg, engine, isAuto)) {
+            std::cerr << "Error: unknown engine " << engineArg 
+                      << " (expected auto, trivial, simplepir, vlhepir or honest-hint)" << std::endl;
+            return 1;
+        }
+        if (!groupBy.empty() || !recordSchema.fields.empty()) {
+            std::cerr << "Error: --engine only applies to single-column databases" << std::endl;
+            return 1;
+        }
+        uint64_t engineN = N;
+        uint64_t engineD = d_value;
+        if (!useRandomGeneration) {
+            // N (and an inferred d) are needed before loading
+            ColumnScan scan = scanColumn(dataFile, d_value, columnName, true);
+            if (!scan.valid || scan.N == 0) {
+                std::cerr << "Error: unable to scan " << dataFile << " for --engine" << std::endl;
+                return 1;
+            }
+            engineN = scan.N;
+            engineD = scan.d;
+        }
+        EngineChoice choice = isAuto ? selectEngine(engineN, engineD, workload) 
+                                     : selectEngine(engineN, engineD, workload, engine);
+        choice.print(std::cout, workload);
+        if (!reportFile.empty()) {
+            if (!saveEngineReport(choice, workload, reportFile)) {
+                return 1;
+            }
+            std::cout << "Engine report written to " << reportFile << std::endl;
+        }
+        std::cout << std::endl;
+        engine = choice.chosen.engine;
+        config = choice.chosen.config;
+    }
+    
     // ========================================================================
     // 2. Analyze the file or generate random data
     // ========================================================================
+    IndexMap indexMap;
+    uint64_t queryRecord = queryIndex;  // record index before the grouped layout
     VLHEPIR pir = [&]() -> VLHEPIR {
         if (useRandomGeneration) {
             std::cout << "=== Random Database Generation ===" << std::endl;
@@ -200,40 +631,196 @@ int main(int argc, char* argv[]) {
             return createVLHEPIRFromRandomData(
                 N,          // number of elements
                 d_value,     // precision in bits
-                true,        // allowTrivial
+                config.allowTrivial,
                 false,       // verbose (set to true to see detailed optimization)
-                false,       // simplePIR
-                1,           // batchSize
-                false        // honestHint
+                config.simplePIR,
+                config.batchSize,
+                config.honestHint
             );
         } else {
-            std::cout << "=== File Analysis ===" << std::endl;
-            FileFormat format = detectFileFormat(dataFile);
-            if (format == FileFormat::PARQUET) {
-                printParquetStats(dataFile, d, columnName);
-            } else {
-                printCSVStats(dataFile, d, true);
+            if (!recordSchema.fields.empty()) {
+                std::cout << "=== Parameters instantiation ===" << std::endl;
+                return createRecordVLHEPIRFromFile(
+                    dataFile,
+                    recordSchema, // columns of a record (widths resolved here)
+                    true,         // hasHeader (for CSV)
+                    true,         // allowTrivial
+                    true          // verbose (reports the record layout)
+                );
+            }
+            
+            // The CSV scan behind the statistics also sizes and validates
+            // the database, the loader does not scan the file again
+            FileFormat format = fromStdin ? FileFormat::CSV : detectFileFormat(dataFile);
+            ColumnScan csvScan;
+            if (!fromStdin) {
+                std::cout << "=== File Analysis ===" << std::endl;
+                if (format == FileFormat::PARQUET) {
+                    printParquetStats(dataFile, d_value, columnName);
+                } else if (format == FileFormat::CSV) {
+                    csvScan = scanCSVColumn(dataFile, d_value, true);
+                    if (csvScan.valid) {
+                        printCSVStats(dataFile, csvScan);
+                    }
+                }
+                std::cout << std::endl;
             }
-            std::cout << std::endl;
             
             // ========================================================================
             // 3. Create PIR from file
             // ========================================================================
             std::cout << "=== Parameters instantiation ===" << std::endl;
+            if (!groupBy.empty()) {
+                return createGroupedVLHEPIRFromFile(
+                    dataFile,
+                    d_value,    // precision in bits (0 = inferred)
+                    groupBy,    // grouping key column
+                    indexMap,   // record -> position map
+                    columnName, // column name (for Parquet)
+                    true,       // hasHeader (for CSV)
+                    true,       // allowTrivial
+                    true        // verbose (reports the layout overhead)
+                );
+            }
+            if (!fromStdin && format == FileFormat::CSV) {
+                return createVLHEPIRFromCSV(
+                    dataFile,
+                    csvScan,    // N and d (inferred when d = 0)
+                    true,       // hasHeader
+                    config.allowTrivial,
+                    false,      // verbose (set to true to see detailed optimization)
+                    config.simplePIR,
+                    config.batchSize,
+                    config.honestHint
+                );
+            }
             return createVLHEPIRFromFile(
                 dataFile,
-                d,          // precision in bits
+                d_value,    // precision in bits (0 = inferred)
                 columnName, // column name (for Parquet)
                 true,       // hasHeader (for CSV)
-                true,       // allowTrivial
+                config.allowTrivial,
                 false,      // verbose (set to true to see detailed optimization)
-                false,      // simplePIR
-                1,          // batchSize
-                false       // honestHint
+                config.simplePIR,
+                config.batchSize,
+                config.honestHint
             );
         }
     }();
-    std::cout << "Database size: " << (N * d) / (8.0 * (1ULL << 20)) << " MiB" << std::endl;
+    // The loader resolves d when it was inferred
+    d_value = pir.dbParams.d;
+    
+    if (!groupBy.empty()) {
+        if (!saveIndexMap(indexMap, indexMapFile)) {
+            return 1;
+        }
+        std::cout << "Index map published to " << indexMapFile << std::endl;
+        if (queryIndex >= indexMap.positions.size()) {
+            std::cerr << "Error: record " << queryIndex << " out of bounds (max: " 
+                      << (indexMap.positions.size() - 1) << ")" << std::endl;
+            return 1;
+        }
+        std::cout << "Record " << queryIndex << " (group " << indexMap.keys[queryIndex] 
+                  << ") is stored at position " << indexMap.positionOf(queryIndex) << std::endl;
+        queryRecord = queryIndex;
+        queryIndex = indexMap.positionOf(queryIndex);
+        for (uint64_t& index : batchIndices) {
+            if (index >= indexMap.positions.size()) {
+                std::cerr << "Error: record " << index << " out of bounds (max: " 
+                          << (indexMap.positions.size() - 1) << ")" << std::endl;
+                return 1;
+            }
+            index = indexMap.positionOf(index);
+        }
+    }
+    
+    if (rangeQuery) {
+        // Range mode replaces the single-query pipeline below. The range
+        // is over records, which --group-by scatters across the layout
+        std::vector<uint64_t> values;
+        if (!groupBy.empty()) {
+            values.resize(indexMap.positions.size());
+            for (uint64_t record = 0; record < values.size(); record++) {
+                values[record] = pir.db.data[indexMap.positionOf(record)].toUnsignedLong();
+            }
+        } else {
+            values.resize(pir.db.N);
+            for (uint64_t i = 0; i < values.size(); i++) {
+                values[i] = pir.db.data[i].toUnsignedLong();
+            }
+        }
+        std::cout << std::endl;
+        bool ok = runRangeSumPIR(values, rangeLo, rangeHi);
+        std::cout << std::endl;
+        std::cout << (ok ? "✓ Range sum matches the database." 
+                         : "✗ Error! Range sum does not match the database.") << std::endl;
+        return ok ? 0 : 1;
+    }
+    
+    if (!batchIndices.empty()) {
+        // Batch mode replaces the single-query pipeline below
+        std::cout << std::endl;
+        bool ok = runBatchPIR(pir.db, d_value, batchIndices);
+        std::cout << std::endl;
+        std::cout << (ok ? "✓ All batch entries match the database." 
+                         : "✗ Error! Some batch entries do not match the database.") << std::endl;
+        return ok ? 0 : 1;
+    }
+    if (twoServer) {
+        // Two-server mode compares both engines on the same database
+        std::cout << std::endl;
+        bool ok = runTwoServerPIR(pir, queryIndex);
+        std::cout << std::endl;
+        std::cout << (ok ? "✓ Two-server result matches the database." 
+                         : "✗ Error! Two-server result does not match the database.") << std::endl;
+        return ok ? 0 : 1;
+    }
+    if (recursive) {
+        // Recursive mode replaces the single-level pipeline below
+        std::cout << std::endl;
+        bool ok = runRecursivePIR(pir, queryIndex);
+        std::cout << std::endl;
+        std::cout << (ok ? "✓ Two-level result matches the database." 
+                         : "✗ Error! Two-level result does not match the database.") << std::endl;
+        return ok ? 0 : 1;
+    }
+    if (!streamFile.empty()) {
+        // Out-of-core mode answers from the packed matrix on disk
+        std::cout << std::endl;
+        bool ok = runStreamingPIR(pir, queryIndex, streamFile, streamBlockMiB);
+        std::cout << std::endl;
+        std::cout << (ok ? "✓ Streamed result matches the database." 
+                         : "✗ Error! Streamed result does not match the database.") << std::endl;
+        return ok ? 0 : 1;
+    }
+    if (numShards > 0) {
+        // Sharded mode answers through server processes holding row slices
+        std::cout << std::endl;
+        bool ok = runShardedPIR(pir, queryIndex, numShards);
+        std::cout << std::endl;
+        std::cout << (ok ? "✓ Sharded result matches the database." 
+                         : "✗ Error! Sharded result does not match the database.") << std::endl;
+        return ok ? 0 : 1;
+    }
+    if (compare) {
+        // Comparison mode runs the pipeline once per engine combination
+        std::cout << std::endl;
+        bool ok = runEngineComparison(pir, queryIndex, reportFile.empty() ? "engine_comparison.json" : reportFile);
+        std::cout << std::endl;
+        std::cout << (ok ? "✓ Every engine recovered the expected value." 
+                         : "✗ Error! An engine recovered a wrong value.") << std::endl;
+        return ok ? 0 : 1;
+    }
+    if (engine == Engine::Trivial) {
+        // The client downloads the database instead of querying it
+        std::cout << std::endl;
+        bool ok = runTrivialDownload(pir, queryIndex, workload);
+        std::cout << std::endl;
+        std::cout << (ok ? "✓ Downloaded value matches the database." 
+                         : "✗ Error! Downloaded value does not match the database.") << std::endl;
+        return ok ? 0 : 1;
+    }
+    std::cout << "Database size: " << (pir.N * d_value) / (8.0 * (1ULL << 20)) << " MiB" << std::endl;
     std::cout << "Database parameters: ";
     pir.dbParams.print();
     std::cout << std::endl;
@@ -243,38 +830,29 @@ int main(int argc, char* argv[]) {
     // ========================================================================
     std::cout << "=== Database Preparation ===" << std::endl;
     
+    // Kernels specialized on (d, p) when the combination is deployed
+    PIRKernels kernels = selectKernels(pir.dbParams);
+    std::cout << "Kernels: " << kernels.describe() << std::endl;
+    
     Matrix D;
-    PackedMatrix D_packed = [&]() -> PackedMatrix {
-        if (useRandomGeneration) {
-            // For random generation, create the packed matrix directly
-            // as in pir_bench.cpp to avoid allocating the complete Database
-            std::cout << "Creating packed matrix directly (like in benchmark)..." << std::endl;
-            PackedMatrix packed = packMatrixHardCoded(pir.dbParams.ell, pir.dbParams.m, pir.dbParams.p, true);
-            std::cout << "Matrix D packed (dimensions: " 
-                      << packed.mat.rows << " x " << packed.mat.cols << ")" << std::endl;
-            
-            // For GenerateHint, we need the unpacked matrix D
-            // We can create a dummy matrix D or use GenerateFakeHint
-            // For now, let's create a dummy matrix D (will be used only for H)
-            D = Matrix(pir.dbParams.ell, pir.dbParams.m);
-            random_fast(D, pir.dbParams.p);
-            std::cout << "Database matrix D created (dimensions: " 
-                      << D.rows << " x " << D.cols << ")" << std::endl;
-            
-            return packed;
-        } else {
-            // For files, use the normal method
-            D = pir.db.packDataInMatrix(pir.dbParams, true);
-            std::cout << "Database packed into matrix D (dimensions: " 
-                      << D.rows << " x " << D.cols << ")" << std::endl;
-            
-            PackedMatrix packed = packMatrixHardCoded(D, pir.lhe.p);
-            std::cout << "Matrix D packed (dimensions: " 
-                      << packed.mat.rows << " x " << packed.mat.cols << ")" << std::endl;
-            
-            return packed;
-        }
-    }();
+    if (useRandomGeneration) {
+        // For random generation, create the database matrix directly
+        // as in pir_bench.cpp to avoid allocating the complete Database
+        D = Matrix(pir.dbParams.ell, pir.dbParams.m);
+        random_fast(D, pir.dbParams.p);
+        std::cout << "Database matrix D created (dimensions: " 
+                  << D.rows << " x " << D.cols << ")" << std::endl;
+    } else {
+        // For files, use the normal method
+        D = pir.db.packDataInMatrix(pir.dbParams, true);
+        std::cout << "Database packed into matrix D (dimensions: " 
+                  << D.rows << " x " << D.cols << ")" << std::endl;
+    }
+    
+    KernelMatrix D_packed = kernels.pack(D);
+    std::cout << "Matrix D packed (dimensions: " 
+              << D_packed.rows << " x " << D_packed.cols << ", "
+              << D_packed.digitsPerWord << " digits per word)" << std::endl;
     std::cout << std::endl;
     
     // ========================================================================
@@ -282,21 +860,56 @@ int main(int argc, char* argv[]) {
     // ========================================================================
     std::cout << "=== Offline Phase ===" << std::endl;
     
-    // Generate public matrix A
-    Matrix A = pir.Init();
-    std::cout << "Public matrix A generated" << std::endl;
-    
-    // Generate hint H with the real matrix D (needed for Recover)
-    Matrix H = pir.GenerateHint(A, D);
-    // Matrix H = pir.GenerateFakeHint();
-    std::cout << "Hint H generated" << std::endl;
+    Matrix A;
+    Matrix H;
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    bool hashed = false;
+    if (!hintCheckpoint.empty() && hintWorkers > 0) {
+        std::cerr << "Error: --hint-checkpoint and --hint-workers cannot be combined" << std::endl;
+        return 1;
+    }
+    if (hintWorkers > 0) {
+        // Row blocks of H = D * A computed by worker processes; the
+        // coordinator checks the stitched hint and hashes it
+        A = pir.Init();
+        std::cout << "Public matrix A generated" << std::endl;
+        if (!generateHintDistributed(pir, kernels, D_packed, A, hintWorkers, hintThreads, H, hash)) {
+            return 1;
+        }
+        hashed = true;
+    } else if (!hintCheckpoint.empty()) {
+        // Tiled H = D * A, resumed from the checkpoint when there is one
+        // (A then comes from the checkpoint as well)
+        if (!generateHintCheckpointed(pir, kernels, D_packed, hintCheckpoint, hintTiling, A, H)) {
+            return 1;
+        }
+        std::cout << "Hint H generated (checkpointed in " << hintCheckpoint << ")" << std::endl;
+    } else {
+        // Generate public matrix A
+        A = pir.Init();
+        std::cout << "Public matrix A generated" << std::endl;
+        
+        // Generate hint H with the real matrix D (needed for Recover),
+        // with the cache-blocked kernel on the packed matrix
+        auto hint_start = std::chrono::high_resolution_clock::now();
+        H = kernels.hint(D_packed, A, hintThreads);
+        // H = pir.GenerateFakeHint();
+        std::chrono::duration<double> hint_seconds = std::chrono::high_resolution_clock::now() - hint_start;
+        std::cout << "Hint H generated in " << hint_seconds.count() * 1000 << " ms ("
+                  << hintGigaOps(D_packed, A.cols) / hint_seconds.count() << " GFLOP/s)" << std::endl;
+    }
     std::cout << "Hint size: " 
               << H.rows * H.cols * sizeof(Elem) / (1ULL << 20) 
               << " MiB" << std::endl;
     
+    if (hintBench && !runHintBenchmark(pir, kernels, D, D_packed, A, hintThreads)) {
+        return 1;
+    }
+    
     // Hash A and H for proof generation (needed for verification)
-    unsigned char hash[SHA256_DIGEST_LENGTH];
-    pir.HashAandH(hash, A, H);
+    if (!hashed) {
+        pir.HashAandH(hash, A, H);
+    }
     
     std::cout << std::endl;
     
@@ -354,13 +967,13 @@ int main(int argc, char* argv[]) {
     std::cout << "=== Online Phase - Answer ===" << std::endl;
     
     // First execution (warmup, not measured)
-    Matrix ans = pir.Answer(ct, D_packed);
+    Matrix ans = kernels.answer(D_packed, ct);
     
     // Measure over multiple iterations (as in the benchmark)
     iters = 10;
     start_time = std::chrono::high_resolution_clock::now();
     for (uint64_t i = 0; i < iters; i++) {
-        ans = pir.Answer(ct, D_packed);
+        ans = kernels.answer(D_packed, ct);
     }
     end_time = std::chrono::high_resolution_clock::now();
     duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
@@ -379,14 +992,17 @@ int main(int argc, char* argv[]) {
     // ========================================================================
     std::cout << "=== Online Phase - Verification ===" << std::endl;
     
+    // Prove works on the library's own packed representation
+    PackedMatrix D_proof = packMatrixHardCoded(D, pir.lhe.p);
+    
     // Generate proof Z for real
-    Matrix Z = pir.Prove(hash, ct, ans, D_packed);
+    Matrix Z = pir.Prove(hash, ct, ans, D_proof);
     
     // Measure over multiple iterations (as in the benchmark)
     iters = 1;  // Proof is more expensive, we measure over 1 iteration
     start_time = std::chrono::high_resolution_clock::now();
     for (uint64_t i = 0; i < iters; i++) {
-        Z = pir.Prove(hash, ct, ans, D_packed);
+        Z = pir.Prove(hash, ct, ans, D_proof);
     }
     end_time = std::chrono::high_resolution_clock::now();
     duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
@@ -417,6 +1033,34 @@ int main(int argc, char* argv[]) {
     std::cout << "Recovered result: ";
     printEntry(result);
     std::cout << std::endl;
+    if (!recordSchema.fields.empty()) {
+        std::vector<uint64_t> fields = recordSchema.split(result);
+        for (uint64_t k = 0; k < fields.size(); k++) {
+            std::cout << "  " << recordSchema.fields[k].name << " = " << fields[k] << std::endl;
+        }
+    }
+    
+    // The same answer holds the whole column of the queried index
+    start_time = std::chrono::high_resolution_clock::now();
+    ColumnRecovery column = RecoverColumn(pir, H, ans, sk, queryIndex);
+    end_time = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    std::cout << "Column recovery time: " << duration.count() << " ms" << std::endl;
+    std::cout << "Column " << column.column << ": " << column.entries.size() 
+              << " entries recovered (indices " << column.firstIndex << " to " 
+              << (column.firstIndex + column.entries.size() - 1) << ")" << std::endl;
+    if (!groupBy.empty()) {
+        // Records of the queried group recovered by this single query
+        const std::string& key = indexMap.keys[queryRecord];
+        uint64_t groupSize = 0, groupRecovered = 0;
+        for (uint64_t record = 0; record < indexMap.positions.size(); record++) {
+            if (indexMap.keys[record] != key) continue;
+            groupSize++;
+            if (column.contains(indexMap.positionOf(record))) groupRecovered++;
+        }
+        std::cout << "Group " << key << ": " << groupRecovered << " of " << groupSize 
+                  << " records recovered by this query" << std::endl;
+    }
     
     // ========================================================================
     // 10. Verification
@@ -424,9 +1068,23 @@ int main(int argc, char* argv[]) {
     std::cout << std::endl;
     std::cout << "=== Verification ===" << std::endl;
     if (canVerify) {
+        uint64_t columnErrors = 0;
+        for (uint64_t i = 0; i < column.entries.size(); i++) {
+            if (!(column.entries[i] == pir.db.getDataAtIndex(column.firstIndex + i))) {
+                columnErrors++;
+            }
+        }
+        if (columnErrors > 0) {
+            std::cout << "✗ Error! " << columnErrors << " of " << column.entries.size() 
+                      << " column entries do not match the database" << std::endl;
+            return 1;
+        }
+        
         if (result == expectedValue) {
             std::cout << "✓ Success! Recovered value matches expected value." 
                       << std::endl;
+            std::cout << "✓ All " << column.entries.size() 
+                      << " entries of the column match the database." << std::endl;
         } else {
             std::cout << "✗ Error! Expected value: ";
             printEntry(expectedValue);
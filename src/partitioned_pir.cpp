@@ -0,0 +1,169 @@
+#include "partitioned_pir.h"
+#include "data_loader.h"
+#include "pir_kernels.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+
+// ============================================================================
+// Time-partitioned databases
+// ============================================================================
+
+/**
+ * Creates an empty PIR instance of N entries with allocated storage
+ */
+static std::unique_ptr<VLHEPIR> newPartition(uint64_t N, uint64_t d, const PIRConfig& config) {
+    std::unique_ptr<VLHEPIR> pir(new VLHEPIR(N, d, config.allowTrivial, config.verbose, config.simplePIR,
+                                             false, config.batchSize, config.honestHint));
+    if (!pir->db.alloc) {
+        pir->db.data = (entry_t*)malloc(N * sizeof(entry_t));
+        pir->db.alloc = true;
+    }
+    return pir;
+}
+
+bool buildPartitionsFromColumn(PIRRegistry& registry,
+                               PartitionIndex& index,
+                               const std::string& filePath,
+                               uint64_t d,
+                               const std::string& partitionColumn,
+                               const std::string& columnName,
+                               bool hasHeader,
+                               const PIRConfig& config) {
+    std::vector<std::string> keys;
+    std::unique_ptr<Database> records = loadRecordsWithKeys(filePath, d, partitionColumn, keys, columnName, hasHeader);
+    if (!records) {
+        return false;
+    }
+
+    // Number the partitions in first-appearance order
+    index = PartitionIndex();
+    std::map<std::string, uint64_t> partitionIds;
+    for (const std::string& key : keys) {
+        auto it = partitionIds.find(key);
+        if (it == partitionIds.end()) {
+            it = partitionIds.emplace(key, index.names.size()).first;
+            index.names.push_back(key);
+            index.sizes.push_back(0);
+        }
+        index.partitionOf.push_back(it->second);
+        index.localIndex.push_back(index.sizes[it->second]++);
+    }
+
+    std::vector<std::vector<uint64_t>> values(index.names.size());
+    for (uint64_t p = 0; p < values.size(); p++) {
+        values[p].reserve(index.sizes[p]);
+    }
+    for (uint64_t i = 0; i < records->N; i++) {
+        values[index.partitionOf[i]].push_back(records->data[i].toUnsignedLong());
+    }
+    records.reset();
+
+    PIRKernels loader = selectKernels(d, 0);
+    for (uint64_t p = 0; p < values.size(); p++) {
+        std::unique_ptr<VLHEPIR> pir = newPartition(values[p].size(), d, config);
+        loader.load(pir->db, 0, values[p].data(), values[p].size());
+        registry.Register(index.names[p], std::move(pir));
+    }
+    return true;
+}
+
+bool buildPartitionsFromDirectory(PIRRegistry& registry,
+                                  PartitionIndex& index,
+                                  const std::string& directory,
+                                  uint64_t d,
+                                  const std::string& columnName,
+                                  bool hasHeader,
+                                  const PIRConfig& config) {
+    std::vector<std::filesystem::path> files;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.is_regular_file() && detectFileFormat(entry.path().string()) != FileFormat::UNKNOWN) {
+            files.push_back(entry.path());
+        }
+    }
+    if (error) {
+        std::cerr << "Error: unable to read directory " << directory << ": " << error.message() << std::endl;
+        return false;
+    }
+    if (files.empty()) {
+        std::cerr << "Error: no CSV or Parquet file in " << directory << std::endl;
+        return false;
+    }
+    std::sort(files.begin(), files.end());
+
+    index = PartitionIndex();
+    for (const auto& file : files) {
+        std::unique_ptr<VLHEPIR> pir(new VLHEPIR(createVLHEPIRFromFile(
+            file.string(), d, columnName, hasHeader, config.allowTrivial, config.verbose,
+            config.simplePIR, config.batchSize, config.honestHint)));
+
+        uint64_t p = index.names.size();
+        index.names.push_back(file.stem().string());
+        index.sizes.push_back(pir->N);
+        for (uint64_t i = 0; i < pir->N; i++) {
+            index.partitionOf.push_back(p);
+            index.localIndex.push_back(i);
+        }
+        registry.Register(index.names[p], std::move(pir));
+    }
+    return true;
+}
+
+// ============================================================================
+// Partition-scoped queries
+// ============================================================================
+
+bool runPartitionedPIR(const std::string& path,
+                       uint64_t d,
+                       const std::string& partitionColumn,
+                       uint64_t queryIndex,
+                       const std::string& columnName,
+                       bool hasHeader,
+                       const PIRConfig& config) {
+    std::cout << "=== Partitioned PIR ===" << std::endl;
+    PIRRegistry registry;
+    PartitionIndex index;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    bool built = std::filesystem::is_directory(path)
+        ? buildPartitionsFromDirectory(registry, index, path, d, columnName, hasHeader, config)
+        : buildPartitionsFromColumn(registry, index, path, d, partitionColumn, columnName, hasHeader, config);
+    if (!built) {
+        return false;
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    std::cout << "Partitions: " << index.names.size() << " (" << index.numRecords() << " records), offline phase: "
+              << duration.count() << " ms" << std::endl;
+
+    if (queryIndex >= index.numRecords()) {
+        std::cerr << "Error: query index " << queryIndex << " out of bounds (max: " 
+                  << (index.numRecords() - 1) << ")" << std::endl;
+        return false;
+    }
+
+    // Route the query to the partition holding the record
+    const std::string& name = index.names[index.partitionOf[queryIndex]];
+    uint64_t local = index.localIndex[queryIndex];
+    std::shared_ptr<const HostedDatabase> partition = registry.Find(name);
+    std::cout << "Record " << queryIndex << " -> partition " << name << ", index " << local << std::endl;
+
+    auto ct_sk = partition->pir->Query(*partition->A, local);
+    Matrix ans;
+    if (!registry.Answer(name, std::get<0>(ct_sk), ans)) {
+        return false;
+    }
+    std::cout << "Answer time: " << partition->metrics.lastAnswerMicros / 1000.0 << " ms, scanned "
+              << partition->pir->N << " of " << index.numRecords() << " records ("
+              << (100.0 * partition->pir->N / index.numRecords()) << "%)" << std::endl;
+
+    entry_t result = partition->pir->Recover(partition->H, ans, std::get<1>(ct_sk), local);
+    entry_t expected = partition->pir->db.getDataAtIndex(local);
+    std::cout << "Recovered value: " << result.toUnsignedLong() 
+              << " (expected: " << expected.toUnsignedLong() << ")" << std::endl;
+    return result == expected;
+}
@@ -0,0 +1,104 @@
+#include "pir_client.h"
+#include <algorithm>
+#include <iostream>
+
+// ============================================================================
+// Column recovery
+// ============================================================================
+
+std::vector<uint64_t> DecodeDigits(const Matrix& H,
+                                   const Matrix& ans,
+                                   const Matrix& sk,
+                                   uint64_t p,
+                                   uint64_t col) {
+    if (H.rows != ans.rows || H.cols != sk.rows) {
+        std::cerr << "Error: hint (" << H.rows << " x " << H.cols << "), answer ("
+                  << ans.rows << " x " << ans.cols << ") and secret key ("
+                  << sk.rows << " x " << sk.cols << ") dimensions do not match" << std::endl;
+        exit(1);
+    }
+
+    // q = 2^logq is the ciphertext modulus (Elem arithmetic wraps around)
+    const uint64_t logq = 8 * sizeof(Elem);
+    std::vector<uint64_t> digits(H.rows);
+
+    for (uint64_t r = 0; r < H.rows; r++) {
+        const Elem* hRow = H.data + r * H.cols;
+        Elem hs = 0;
+        for (uint64_t k = 0; k < H.cols; k++) {
+            hs += hRow[k] * sk.data[k * sk.cols + col];
+        }
+        Elem noisy = ans.data[r * ans.cols + col] - hs;
+        unsigned __int128 scaled = (unsigned __int128)noisy * p + ((unsigned __int128)1 << (logq - 1));
+        digits[r] = static_cast<uint64_t>(scaled >> logq) % p;
+    }
+    return digits;
+}
+
+ColumnRecovery RecoverColumn(const VLHEPIR& pir,
+                             const Matrix& H,
+                             const Matrix& ans,
+                             const Matrix& sk,
+                             uint64_t queryIndex) {
+    return RecoverColumn(DBLayout::fromParams(pir.dbParams), H, ans, sk, queryIndex);
+}
+
+ColumnRecovery RecoverColumn(const DBLayout& layout,
+                             const Matrix& H,
+                             const Matrix& ans,
+                             const Matrix& sk,
+                             uint64_t queryIndex) {
+    ColumnRecovery result;
+    result.column = layout.columnOf(queryIndex);
+    result.firstIndex = layout.firstIndexOfColumn(result.column);
+
+    std::vector<uint64_t> digits = DecodeDigits(H, ans, sk, layout.p);
+
+    uint64_t count = std::min(layout.entriesPerColumn,
+                              layout.N > result.firstIndex ? layout.N - result.firstIndex : 0);
+    result.entries.resize(count);
+
+    const uint64_t entryMask = (layout.d >= 64) ? UINT64_MAX : ((1ULL << layout.d) - 1);
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t index = result.firstIndex + i;
+        uint64_t row = layout.rowOf(index);
+        if (layout.elemsPerEntry == 1) {
+            uint64_t value = (digits[row] >> layout.bitOffsetOf(index)) & entryMask;
+            result.entries[i] = entry_t(static_cast<unsigned long>(value));
+        } else {
+            entry_t value = entry_t(0);
+            for (uint64_t k = 0; k < layout.elemsPerEntry; k++) {
+                value = value + (entry_t(static_cast<unsigned long>(digits[row + k])) << (k * layout.bitsPerElem));
+            }
+            result.entries[i] = value;
+        }
+    }
+    return result;
+}
+
+// ============================================================================
+// Sharded answers
+// ============================================================================
+
+Matrix ConcatenateAnswers(const std::vector<Matrix>& partials) {
+    if (partials.empty()) {
+        return Matrix();
+    }
+    uint64_t rows = 0;
+    for (const Matrix& part : partials) {
+        if (part.cols != partials[0].cols) {
+            std::cerr << "Error: partial answers have " << partials[0].cols << " and "
+                      << part.cols << " columns" << std::endl;
+            return Matrix();
+        }
+        rows += part.rows;
+    }
+
+    Matrix ans(rows, partials[0].cols);
+    uint64_t row = 0;
+    for (const Matrix& part : partials) {
+        std::copy(part.data, part.data + part.rows * part.cols, ans.data + row * ans.cols);
+        row += part.rows;
+    }
+    return ans;
+}
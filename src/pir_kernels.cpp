@@ -0,0 +1,518 @@
+#include "pir_kernels.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+// ============================================================================
+// Utility functions
+// ============================================================================
+
+uint64_t digitBitsForModulus(uint64_t p) {
+    uint64_t bits = 0;
+    while (bits < 64 && (1ULL << bits) < p) {
+        bits++;
+    }
+    return std::max<uint64_t>(bits, 1);
+}
+
+bool fuseKernelMatrices(const std::vector<const KernelMatrix*>& Ds, FusedKernelMatrix& fused) {
+    if (Ds.empty()) {
+        std::cerr << "Error: no database to fuse" << std::endl;
+        return false;
+    }
+    const KernelMatrix& first = *Ds[0];
+    for (const KernelMatrix* D : Ds) {
+        if (D->rows != first.rows || D->cols != first.cols || D->logp != first.logp) {
+            std::cerr << "Error: cannot fuse a " << D->rows << "x" << D->cols << " database (log2 p="
+                      << D->logp << ") with a " << first.rows << "x" << first.cols
+                      << " one (log2 p=" << first.logp << ")" << std::endl;
+            return false;
+        }
+    }
+
+    fused.numDatabases = Ds.size();
+    fused.rows = first.rows;
+    fused.cols = first.cols;
+    fused.logp = first.logp;
+    fused.digitsPerWord = first.digitsPerWord;
+    fused.wordsPerRow = first.wordsPerRow;
+    fused.words.resize(first.words.size() * Ds.size());
+
+    uint64_t numWords = first.words.size();
+    for (uint64_t k = 0; k < Ds.size(); k++) {
+        const uint64_t* in = Ds[k]->words.data();
+        for (uint64_t i = 0; i < numWords; i++) {
+            fused.words[i * Ds.size() + k] = in[i];
+        }
+    }
+    return true;
+}
+
+std::vector<Elem> padQuery(const Matrix& ct, uint64_t paddedRows) {
+    std::vector<Elem> padded(paddedRows * ct.cols, 0);
+    memcpy(padded.data(), ct.data, ct.rows * ct.cols * sizeof(Elem));
+    return padded;
+}
+
+// ============================================================================
+// Specialized kernels
+// ============================================================================
+
+template <uint64_t LogP>
+KernelMatrix FixedKernel<LogP>::pack(const Matrix& D, uint64_t) {
+    KernelMatrix packed;
+    packed.rows = D.rows;
+    packed.cols = D.cols;
+    packed.logp = LogP;
+    packed.digitsPerWord = kDigitsPerWord;
+    packed.wordsPerRow = (D.cols + kDigitsPerWord - 1) / kDigitsPerWord;
+    packed.words.assign(packed.rows * packed.wordsPerRow, 0);
+
+    for (uint64_t r = 0; r < D.rows; r++) {
+        const Elem* row = D.data + r * D.cols;
+        uint64_t* out = packed.words.data() + r * packed.wordsPerRow;
+        for (uint64_t c = 0; c < D.cols; c++) {
+            out[c / kDigitsPerWord] |= (uint64_t(row[c]) & kDigitMask) << ((c % kDigitsPerWord) * LogP);
+        }
+    }
+    return packed;
+}
+
+template <uint64_t LogP>
+void FixedKernel<LogP>::answerRows(Elem* out, const KernelMatrix& D, const Elem* ct,
+                                   uint64_t batch, uint64_t rowBegin, uint64_t rowEnd) {
+    if (batch == 1) {
+        for (uint64_t r = rowBegin; r < rowEnd; r++) {
+            const uint64_t* row = D.data() + r * D.wordsPerRow;
+            Elem acc = 0;
+            for (uint64_t w = 0; w < D.wordsPerRow; w++) {
+                uint64_t word = row[w];
+                const Elem* q = ct + w * kDigitsPerWord;
+                for (uint64_t k = 0; k < kDigitsPerWord; k++) {
+                    acc += Elem(word & kDigitMask) * q[k];
+                    word >>= LogP;
+                }
+            }
+            out[r] = acc;
+        }
+        return;
+    }
+
+    for (uint64_t r = rowBegin; r < rowEnd; r++) {
+        const uint64_t* row = D.data() + r * D.wordsPerRow;
+        Elem* acc = out + r * batch;
+        memset(acc, 0, batch * sizeof(Elem));
+        for (uint64_t w = 0; w < D.wordsPerRow; w++) {
+            uint64_t word = row[w];
+            const Elem* q = ct + w * kDigitsPerWord * batch;
+            for (uint64_t k = 0; k < kDigitsPerWord; k++) {
+                Elem digit = Elem(word & kDigitMask);
+                for (uint64_t j = 0; j < batch; j++) {
+                    acc[j] += digit * q[k * batch + j];
+                }
+                word >>= LogP;
+            }
+        }
+    }
+}
+
+template <uint64_t LogP>
+void FixedKernel<LogP>::answerRowsFused(Elem* out, const FusedKernelMatrix& D, const Elem* ct,
+                                        uint64_t batch, uint64_t rowBegin, uint64_t rowEnd) {
+    const uint64_t K = D.numDatabases;
+    for (uint64_t r = rowBegin; r < rowEnd; r++) {
+        const uint64_t* row = D.words.data() + r * D.wordsPerRow * K;
+        Elem* acc = out + r * K * batch;
+        memset(acc, 0, K * batch * sizeof(Elem));
+        for (uint64_t w = 0; w < D.wordsPerRow; w++) {
+            // This block of ct stays in registers / L1 across the K databases
+            const Elem* q = ct + w * kDigitsPerWord * batch;
+            const uint64_t* words = row + w * K;
+            for (uint64_t k = 0; k < K; k++) {
+                uint64_t word = words[k];
+                if (batch == 1) {
+                    Elem sum = 0;
+                    for (uint64_t i = 0; i < kDigitsPerWord; i++) {
+                        sum += Elem(word & kDigitMask) * q[i];
+                        word >>= LogP;
+                    }
+                    acc[k] += sum;
+                    continue;
+                }
+                Elem* acc_k = acc + k * batch;
+                for (uint64_t i = 0; i < kDigitsPerWord; i++) {
+                    Elem digit = Elem(word & kDigitMask);
+                    for (uint64_t j = 0; j < batch; j++) {
+                        acc_k[j] += digit * q[i * batch + j];
+                    }
+                    word >>= LogP;
+                }
+            }
+        }
+    }
+}
+
+template <uint64_t LogP>
+void FixedKernel<LogP>::hintRows(Elem* out, const KernelMatrix& D, const Elem* A,
+                                 uint64_t n, uint64_t rowBegin, uint64_t rowEnd) {
+    const uint64_t colBlock = std::min(n, HINT_BLOCK_COLS);
+    const uint64_t wordBlock = std::max<uint64_t>(HINT_BLOCK_BYTES / (kDigitsPerWord * colBlock * sizeof(Elem)), 1);
+    for (uint64_t r = rowBegin; r < rowEnd; r++) {
+        memset(out + r * n, 0, n * sizeof(Elem));
+    }
+
+    for (uint64_t j0 = 0; j0 < n; j0 += colBlock) {
+        const uint64_t cols = std::min(colBlock, n - j0);
+        for (uint64_t w0 = 0; w0 < D.wordsPerRow; w0 += wordBlock) {
+            const uint64_t w1 = std::min(D.wordsPerRow, w0 + wordBlock);
+            // The panel of A (rows of words w0..w1, columns j0..j0+cols) stays
+            // in L2 while every row multiplies it; two rows share each load
+            uint64_t r = rowBegin;
+            for (; r + 1 < rowEnd; r += 2) {
+                const uint64_t* row0 = D.data() + r * D.wordsPerRow;
+                const uint64_t* row1 = row0 + D.wordsPerRow;
+                Elem* acc0 = out + r * n + j0;
+                Elem* acc1 = acc0 + n;
+                for (uint64_t w = w0; w < w1; w++) {
+                    uint64_t word0 = row0[w];
+                    uint64_t word1 = row1[w];
+                    const Elem* q = A + w * kDigitsPerWord * n + j0;
+                    for (uint64_t k = 0; k < kDigitsPerWord; k++) {
+                        Elem digit0 = Elem(word0 & kDigitMask);
+                        Elem digit1 = Elem(word1 & kDigitMask);
+                        const Elem* qk = q + k * n;
+                        for (uint64_t j = 0; j < cols; j++) {
+                            acc0[j] += digit0 * qk[j];
+                            acc1[j] += digit1 * qk[j];
+                        }
+                        word0 >>= LogP;
+                        word1 >>= LogP;
+                    }
+                }
+            }
+            for (; r < rowEnd; r++) {
+                const uint64_t* row = D.data() + r * D.wordsPerRow;
+                Elem* acc = out + r * n + j0;
+                for (uint64_t w = w0; w < w1; w++) {
+                    uint64_t word = row[w];
+                    const Elem* q = A + w * kDigitsPerWord * n + j0;
+                    for (uint64_t k = 0; k < kDigitsPerWord; k++) {
+                        Elem digit = Elem(word & kDigitMask);
+                        const Elem* qk = q + k * n;
+                        for (uint64_t j = 0; j < cols; j++) {
+                            acc[j] += digit * qk[j];
+                        }
+                        word >>= LogP;
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <uint64_t D>
+void FixedLoader<D>::load(Database& db, uint64_t offset, const uint64_t* values, uint64_t count, uint64_t) {
+    count = std::min(count, db.N > offset ? db.N - offset : 0);
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t value = values[i];
+        if (value > kMaxValue) {
+            std::cerr << "Warning: value too large at line " << (offset + i + 1) << ": " << value
+                      << " (max for d=" << D << ": " << kMaxValue
+                      << ", used " << kMaxValue << ")" << std::endl;
+            value = kMaxValue;
+        }
+        db.data[offset + i] = entry_t(static_cast<unsigned long>(value));
+    }
+}
+
+// ============================================================================
+// Generic kernels (runtime d and p)
+// ============================================================================
+
+static KernelMatrix packGeneric(const Matrix& D, uint64_t logp) {
+    KernelMatrix packed;
+    packed.rows = D.rows;
+    packed.cols = D.cols;
+    packed.logp = logp;
+    packed.digitsPerWord = 64 / logp;
+    packed.wordsPerRow = (D.cols + packed.digitsPerWord - 1) / packed.digitsPerWord;
+    packed.words.assign(packed.rows * packed.wordsPerRow, 0);
+
+    uint64_t mask = (logp == 64) ? UINT64_MAX : ((1ULL << logp) - 1);
+    for (uint64_t r = 0; r < D.rows; r++) {
+        const Elem* row = D.data + r * D.cols;
+        uint64_t* out = packed.words.data() + r * packed.wordsPerRow;
+        for (uint64_t c = 0; c < D.cols; c++) {
+            out[c / packed.digitsPerWord] |= (uint64_t(row[c]) & mask) << ((c % packed.digitsPerWord) * logp);
+        }
+    }
+    return packed;
+}
+
+static void answerRowsGeneric(Elem* out, const KernelMatrix& D, const Elem* ct,
+                              uint64_t batch, uint64_t rowBegin, uint64_t rowEnd) {
+    uint64_t mask = (D.logp == 64) ? UINT64_MAX : ((1ULL << D.logp) - 1);
+    for (uint64_t r = rowBegin; r < rowEnd; r++) {
+        const uint64_t* row = D.data() + r * D.wordsPerRow;
+        Elem* acc = out + r * batch;
+        memset(acc, 0, batch * sizeof(Elem));
+        for (uint64_t w = 0; w < D.wordsPerRow; w++) {
+            uint64_t word = row[w];
+            const Elem* q = ct + w * D.digitsPerWord * batch;
+            for (uint64_t k = 0; k < D.digitsPerWord; k++) {
+                Elem digit = Elem(word & mask);
+                for (uint64_t j = 0; j < batch; j++) {
+                    acc[j] += digit * q[k * batch + j];
+                }
+                word = (D.logp == 64) ? 0 : (word >> D.logp);
+            }
+        }
+    }
+}
+
+static void answerRowsFusedGeneric(Elem* out, const FusedKernelMatrix& D, const Elem* ct,
+                                   uint64_t batch, uint64_t rowBegin, uint64_t rowEnd) {
+    const uint64_t K = D.numDatabases;
+    uint64_t mask = (D.logp == 64) ? UINT64_MAX : ((1ULL << D.logp) - 1);
+    for (uint64_t r = rowBegin; r < rowEnd; r++) {
+        const uint64_t* row = D.words.data() + r * D.wordsPerRow * K;
+        Elem* acc = out + r * K * batch;
+        memset(acc, 0, K * batch * sizeof(Elem));
+        for (uint64_t w = 0; w < D.wordsPerRow; w++) {
+            const Elem* q = ct + w * D.digitsPerWord * batch;
+            for (uint64_t k = 0; k < K; k++) {
+                uint64_t word = row[w * K + k];
+                Elem* acc_k = acc + k * batch;
+                for (uint64_t i = 0; i < D.digitsPerWord; i++) {
+                    Elem digit = Elem(word & mask);
+                    for (uint64_t j = 0; j < batch; j++) {
+                        acc_k[j] += digit * q[i * batch + j];
+                    }
+                    word = (D.logp == 64) ? 0 : (word >> D.logp);
+                }
+            }
+        }
+    }
+}
+
+static void hintRowsGeneric(Elem* out, const KernelMatrix& D, const Elem* A,
+                            uint64_t n, uint64_t rowBegin, uint64_t rowEnd) {
+    uint64_t mask = (D.logp == 64) ? UINT64_MAX : ((1ULL << D.logp) - 1);
+    const uint64_t colBlock = std::min(n, HINT_BLOCK_COLS);
+    const uint64_t wordBlock = std::max<uint64_t>(HINT_BLOCK_BYTES / (D.digitsPerWord * colBlock * sizeof(Elem)), 1);
+    for (uint64_t r = rowBegin; r < rowEnd; r++) {
+        memset(out + r * n, 0, n * sizeof(Elem));
+    }
+
+    for (uint64_t j0 = 0; j0 < n; j0 += colBlock) {
+        const uint64_t cols = std::min(colBlock, n - j0);
+        for (uint64_t w0 = 0; w0 < D.wordsPerRow; w0 += wordBlock) {
+            const uint64_t w1 = std::min(D.wordsPerRow, w0 + wordBlock);
+            for (uint64_t r = rowBegin; r < rowEnd; r++) {
+                const uint64_t* row = D.data() + r * D.wordsPerRow;
+                Elem* acc = out + r * n + j0;
+                for (uint64_t w = w0; w < w1; w++) {
+                    uint64_t word = row[w];
+                    const Elem* q = A + w * D.digitsPerWord * n + j0;
+                    for (uint64_t k = 0; k < D.digitsPerWord; k++) {
+                        Elem digit = Elem(word & mask);
+                        const Elem* qk = q + k * n;
+                        for (uint64_t j = 0; j < cols; j++) {
+                            acc[j] += digit * qk[j];
+                        }
+                        word = (D.logp == 64) ? 0 : (word >> D.logp);
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void loadGeneric(Database& db, uint64_t offset, const uint64_t* values, uint64_t count, uint64_t d) {
+    entry_t maxValue = (entry_t(1) << d) - entry_t(1);
+    count = std::min(count, db.N > offset ? db.N - offset : 0);
+    for (uint64_t i = 0; i < count; i++) {
+        entry_t entryValue = entry_t(static_cast<unsigned long>(values[i]));
+        if (entryValue > maxValue) {
+            std::cerr << "Warning: value too large at line " << (offset + i + 1) << ": " << values[i]
+                      << " (max for d=" << d << ": " << maxValue.toUnsignedLong()
+                      << ", used " << maxValue.toUnsignedLong() << ")" << std::endl;
+            entryValue = maxValue;
+        }
+        db.data[offset + i] = entryValue;
+    }
+}
+
+// ============================================================================
+// Runtime dispatcher
+// ============================================================================
+
+Matrix PIRKernels::answer(const KernelMatrix& D, const Matrix& ct, uint64_t numThreads) const {
+    if (ct.rows != D.cols) {
+        std::cerr << "Error: query has " << ct.rows << " rows, database has "
+                  << D.cols << " columns" << std::endl;
+        exit(1);
+    }
+
+    uint64_t batch = ct.cols;
+    std::vector<Elem> padded = padQuery(ct, D.wordsPerRow * D.digitsPerWord);
+    Matrix ans(D.rows, batch);
+    answerBlock(ans.data, D, padded.data(), batch, numThreads);
+    return ans;
+}
+
+void PIRKernels::answerBlock(Elem* out, const KernelMatrix& block, const Elem* padded,
+                             uint64_t batch, uint64_t numThreads) const {
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numThreads = std::min<uint64_t>(numThreads, std::max<uint64_t>(block.rows, 1));
+
+    if (numThreads == 1) {
+        answerRows(out, block, padded, batch, 0, block.rows);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    uint64_t rowsPerThread = (block.rows + numThreads - 1) / numThreads;
+    for (uint64_t t = 0; t < numThreads; t++) {
+        uint64_t begin = t * rowsPerThread;
+        uint64_t end = std::min(block.rows, begin + rowsPerThread);
+        if (begin >= end) break;
+        workers.emplace_back(answerRows, out, std::cref(block), padded, batch, begin, end);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+Matrix PIRKernels::hint(const KernelMatrix& D, const Matrix& A, uint64_t numThreads) const {
+    if (A.rows != D.cols) {
+        std::cerr << "Error: A has " << A.rows << " rows, database has "
+                  << D.cols << " columns" << std::endl;
+        exit(1);
+    }
+
+    std::vector<Elem> padded = padQuery(A, D.wordsPerRow * D.digitsPerWord);
+    Matrix H(D.rows, A.cols);
+    hintBlock(H.data, D, padded.data(), A.cols, numThreads);
+    return H;
+}
+
+void PIRKernels::hintBlock(Elem* out, const KernelMatrix& block, const Elem* padded,
+                           uint64_t n, uint64_t numThreads) const {
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numThreads = std::min<uint64_t>(numThreads, std::max<uint64_t>(block.rows, 1));
+
+    if (numThreads == 1) {
+        hintRows(out, block, padded, n, 0, block.rows);
+        return;
+    }
+
+    // Even row counts per thread keep the two-row kernel on its fast path
+    std::vector<std::thread> workers;
+    uint64_t rowsPerThread = (block.rows + numThreads - 1) / numThreads;
+    rowsPerThread += rowsPerThread % 2;
+    for (uint64_t t = 0; t < numThreads; t++) {
+        uint64_t begin = t * rowsPerThread;
+        uint64_t end = std::min(block.rows, begin + rowsPerThread);
+        if (begin >= end) break;
+        workers.emplace_back(hintRows, out, std::cref(block), padded, n, begin, end);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::vector<Matrix> PIRKernels::answerFused(const FusedKernelMatrix& D, const Matrix& ct, uint64_t numThreads) const {
+    if (ct.rows != D.cols) {
+        std::cerr << "Error: query has " << ct.rows << " rows, databases have "
+                  << D.cols << " columns" << std::endl;
+        exit(1);
+    }
+
+    const uint64_t K = D.numDatabases;
+    uint64_t batch = ct.cols;
+    std::vector<Elem> padded = padQuery(ct, D.wordsPerRow * D.digitsPerWord);
+    std::vector<Elem> out(D.rows * K * batch);
+
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numThreads = std::min<uint64_t>(numThreads, std::max<uint64_t>(D.rows, 1));
+
+    std::vector<std::thread> workers;
+    uint64_t rowsPerThread = (D.rows + numThreads - 1) / numThreads;
+    for (uint64_t t = 0; t < numThreads; t++) {
+        uint64_t begin = t * rowsPerThread;
+        uint64_t end = std::min(D.rows, begin + rowsPerThread);
+        if (begin >= end) break;
+        workers.emplace_back(answerRowsFused, out.data(), std::cref(D), padded.data(), batch, begin, end);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // Split the interleaved result into one answer per database
+    std::vector<Matrix> answers;
+    answers.reserve(K);
+    for (uint64_t k = 0; k < K; k++) {
+        Matrix ans(D.rows, batch);
+        for (uint64_t r = 0; r < D.rows; r++) {
+            memcpy(ans.data + r * batch, out.data() + (r * K + k) * batch, batch * sizeof(Elem));
+        }
+        answers.push_back(std::move(ans));
+    }
+    return answers;
+}
+
+std::string PIRKernels::describe() const {
+    std::ostringstream ss;
+    ss << (specialized ? "specialized" : "generic")
+       << " (d=" << d << ", log2 p=" << logp << ")";
+    return ss.str();
+}
+
+PIRKernels selectKernels(uint64_t d, uint64_t p) {
+    PIRKernels kernels;
+    kernels.d = d;
+    kernels.logp = digitBitsForModulus(p);
+
+    // Each component is taken from any deployed configuration sharing its
+    // parameter; the set is "specialized" only when the exact pair is deployed
+    kernels.packFn = &packGeneric;
+    kernels.answerRows = &answerRowsGeneric;
+    kernels.answerRowsFused = &answerRowsFusedGeneric;
+    kernels.hintRows = &hintRowsGeneric;
+    kernels.loadFn = &loadGeneric;
+
+#define PIR_SELECT_CONFIG(D_BITS, LOGP)                                \
+    if (kernels.logp == LOGP) {                                        \
+        kernels.packFn = &FixedKernel<LOGP>::pack;                     \
+        kernels.answerRows = &FixedKernel<LOGP>::answerRows;           \
+        kernels.answerRowsFused = &FixedKernel<LOGP>::answerRowsFused; \
+        kernels.hintRows = &FixedKernel<LOGP>::hintRows;               \
+    }                                                                  \
+    if (d == D_BITS && kernels.logp == LOGP) {                         \
+        kernels.specialized = true;                                    \
+    }
+    PIR_DEPLOYED_CONFIGS(PIR_SELECT_CONFIG)
+#undef PIR_SELECT_CONFIG
+
+#define PIR_SELECT_WIDTH(D_BITS)                     \
+    if (d == D_BITS) {                               \
+        kernels.loadFn = &FixedLoader<D_BITS>::load; \
+    }
+    PIR_DEPLOYED_WIDTHS(PIR_SELECT_WIDTH)
+#undef PIR_SELECT_WIDTH
+
+    return kernels;
+}
+
+PIRKernels selectKernels(const DBParams& params) {
+    return selectKernels(params.d, params.p);
+}
@@ -0,0 +1,524 @@
+#include "pir_registry.h"
+#include "data_loader.h"
+#include "db_layout.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <thread>
+
+// ============================================================================
+// Registry of named databases
+// ============================================================================
+
+uint64_t PIRRegistry::Register(const std::string& name, std::unique_ptr<VLHEPIR> pir,
+                               uint64_t size, double reserve) {
+    auto hosted = std::make_shared<HostedDatabase>();
+    hosted->name = name;
+    hosted->size = size ? size : pir->N;
+    hosted->reserve = std::min(std::max(reserve, 0.0), MAX_RESERVE);
+    hosted->kernels = selectKernels(pir->dbParams);
+
+    // A (m x n) only depends on m and the LWE dimension n, so it is
+    // generated once per (m, n) and shared by every database with that shape
+    const std::pair<uint64_t, uint64_t> shape(pir->dbParams.m, pir->lhe.n);
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto it = publicMatrices_.find(shape);
+        if (it == publicMatrices_.end()) {
+            it = publicMatrices_.emplace(shape, std::make_shared<const Matrix>(pir->Init())).first;
+        }
+        hosted->A = it->second;
+    }
+
+    // The offline phase runs outside the lock, queries keep being served
+    Matrix D = pir->db.packDataInMatrix(pir->dbParams, false);
+    hosted->D = hosted->kernels.pack(D);
+    hosted->H = hosted->kernels.hint(hosted->D, *hosted->A, numThreads_);
+    hosted->pir = std::move(pir);
+    return Publish(std::move(hosted));
+}
+
+std::future<uint64_t> PIRRegistry::RegisterAsync(const std::string& name, std::unique_ptr<VLHEPIR> pir,
+                                                 uint64_t size, double reserve) {
+    return std::async(std::launch::async, [this, name, size, reserve](std::unique_ptr<VLHEPIR> next) {
+        return Register(name, std::move(next), size, reserve);
+    }, std::move(pir));
+}
+
+/**
+ * Z_p digits of one column of D, laid out as Database::packDataInMatrix
+ * does (entries of at most 64 bits)
+ */
+static void columnDigits(const DBLayout& layout, Database& db, uint64_t column, std::vector<uint64_t>& digits) {
+    std::fill(digits.begin(), digits.end(), 0);
+    const uint64_t first = layout.firstIndexOfColumn(column);
+    const uint64_t last = std::min(layout.N, first + layout.entriesPerColumn);
+    const uint64_t mask = (1ULL << layout.bitsPerElem) - 1;
+    for (uint64_t i = first; i < last; i++) {
+        uint64_t value = db.getDataAtIndex(i).toUnsignedLong();
+        uint64_t row = layout.rowOf(i);
+        if (layout.elemsPerEntry == 1) {
+            digits[row] |= value << layout.bitOffsetOf(i);
+            continue;
+        }
+        for (uint64_t k = 0; k < layout.elemsPerEntry; k++) {
+            uint64_t shift = k * layout.bitsPerElem;
+            digits[row + k] = (shift < 64) ? (value >> shift) & mask : 0;
+        }
+    }
+}
+
+/**
+ * Future already holding epoch
+ */
+static std::shared_future<uint64_t> readyEpoch(uint64_t epoch) {
+    std::promise<uint64_t> promise;
+    promise.set_value(epoch);
+    return promise.get_future().share();
+}
+
+std::shared_ptr<PIRRegistry::Writer> PIRRegistry::WriterOf(const std::string& name) {
+    std::lock_guard<std::mutex> lock(writersMutex_);
+    std::shared_ptr<Writer>& writer = writers_[name];
+    if (!writer) {
+        writer = std::make_shared<Writer>();
+    }
+    return writer;
+}
+
+uint64_t PIRRegistry::Extend(const std::string& name, const std::vector<uint64_t>& values,
+                             const PIRConfig& config, bool* incremental) {
+    return ExtendAsync(name, values, config, incremental).get();
+}
+
+std::shared_future<uint64_t> PIRRegistry::ExtendAsync(const std::string& name, const std::vector<uint64_t>& values,
+                                                      const PIRConfig& config, bool* incremental) {
+    // Read-modify-publish: the previous extension of name must be published
+    // first, or its entries would be lost
+    std::shared_ptr<Writer> writer = WriterOf(name);
+    std::lock_guard<std::mutex> writing(writer->mutex);
+    if (writer->pending.valid()) {
+        writer->pending.wait();
+    }
+    std::shared_ptr<const HostedDatabase> current = Find(name);
+    if (!current) {
+        std::cerr << "Error: unknown database '" << name << "'" << std::endl;
+        return readyEpoch(0);
+    }
+    if (values.empty()) {
+        return readyEpoch(current->epoch);
+    }
+
+    // The entries of the current epoch are copied, only the new ones are
+    // loaded. They fill the reserved slots if there are enough left,
+    // otherwise the capacity grows to the new size plus its reserve
+    const VLHEPIR& previous = *current->pir;
+    const uint64_t oldSize = current->size;
+    const uint64_t size = oldSize + values.size();
+    uint64_t N = previous.N;
+    if (size > N) {
+        N = size + uint64_t(size * current->reserve);
+    }
+    uint64_t d = previous.dbParams.d;
+    for (uint64_t value : values) {
+        d = std::max(d, calculateBitSize(value));
+    }
+    std::unique_ptr<VLHEPIR> pir(new VLHEPIR(N, d, config.allowTrivial, config.verbose, config.simplePIR,
+                                             false, config.batchSize, config.honestHint));
+    if (!pir->db.alloc) {
+        pir->db.data = (entry_t*)malloc(N * sizeof(entry_t));
+        pir->db.alloc = true;
+    }
+    memset(pir->db.data, 0, N * sizeof(entry_t));
+    std::copy(previous.db.data, previous.db.data + oldSize, pir->db.data);
+    selectKernels(d, 0).load(pir->db, oldSize, values.data(), values.size());
+
+    const DBParams& was = previous.dbParams;
+    const DBParams& now = pir->dbParams;
+    bool sameShape = now.d == was.d && now.ell == was.ell && now.m == was.m && now.p == was.p &&
+                     pir->lhe.n == previous.lhe.n;
+    if (incremental) {
+        *incremental = sameShape;
+    }
+    if (!sameShape) {
+        writer->pending = RegisterAsync(name, std::move(pir), size, current->reserve).share();
+        return writer->pending;
+    }
+
+    // Same shape: only the columns holding new entries change, and each
+    // changed digit moves its row of H by delta * (that column's row of A)
+    auto hosted = std::make_shared<HostedDatabase>();
+    hosted->name = name;
+    hosted->size = size;
+    hosted->reserve = current->reserve;
+    hosted->kernels = current->kernels;
+    hosted->A = current->A;
+    hosted->D = current->D;
+    hosted->H = Matrix(current->H.rows, current->H.cols);
+    std::copy(current->H.data, current->H.data + current->H.rows * current->H.cols, hosted->H.data);
+
+    KernelMatrix& D = hosted->D;
+    const Matrix& A = *hosted->A;
+    const uint64_t n = hosted->H.cols;
+    const uint64_t mask = (D.logp == 64) ? UINT64_MAX : ((1ULL << D.logp) - 1);
+    DBLayout layout = DBLayout::fromParams(now);
+    std::vector<uint64_t> digits(D.rows);
+    for (uint64_t c = layout.columnOf(oldSize); c <= layout.columnOf(size - 1); c++) {
+        columnDigits(layout, pir->db, c, digits);
+        const uint64_t word = c / D.digitsPerWord;
+        const uint64_t shift = (c % D.digitsPerWord) * D.logp;
+        const Elem* a = A.data + c * n;
+        for (uint64_t r = 0; r < D.rows; r++) {
+            uint64_t& packed = D.words[r * D.wordsPerRow + word];
+            Elem before = Elem((packed >> shift) & mask);
+            Elem after = Elem(digits[r] & mask);
+            if (before == after) continue;
+            packed = (packed & ~(mask << shift)) | (uint64_t(after) << shift);
+            Elem delta = after - before;
+            Elem* h = hosted->H.data + r * n;
+            for (uint64_t k = 0; k < n; k++) {
+                h[k] += delta * a[k];
+            }
+        }
+    }
+    hosted->pir = std::move(pir);
+    return readyEpoch(Publish(std::move(hosted)));
+}
+
+/**
+ * Drops the epochs that have been freed since they were retired
+ */
+static void pruneRetired(std::vector<std::weak_ptr<const HostedDatabase>>& retired) {
+    retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                 [](const std::weak_ptr<const HostedDatabase>& old) { return old.expired(); }),
+                  retired.end());
+}
+
+uint64_t PIRRegistry::Publish(std::shared_ptr<HostedDatabase> hosted) {
+    std::shared_ptr<const HostedDatabase> previous;
+    uint64_t epoch = 0;
+    uint64_t micros = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        std::shared_ptr<const HostedDatabase>& current = databases_[hosted->name];
+        hosted->epoch = current ? current->epoch + 1 : 1;
+        epoch = hosted->epoch;
+        previous = std::move(current);
+        current = std::move(hosted);
+        if (previous) {
+            pruneRetired(retired_);
+            retired_.push_back(previous);
+        }
+        auto end_time = std::chrono::high_resolution_clock::now();
+        micros = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    }
+    if (previous) {
+        swaps_++;
+        uint64_t longest = maxSwapMicros_;
+        while (micros > longest && !maxSwapMicros_.compare_exchange_weak(longest, micros)) {
+        }
+    }
+    // previous is released here, outside the lock: freeing an epoch never
+    // delays answers, and it only happens once its last answer has finished
+    return epoch;
+}
+
+bool PIRRegistry::Unregister(const std::string& name) {
+    std::shared_ptr<const HostedDatabase> previous;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = databases_.find(name);
+    if (it == databases_.end()) {
+        return false;
+    }
+    previous = std::move(it->second);
+    databases_.erase(it);
+    pruneRetired(retired_);
+    retired_.push_back(previous);
+    lock.unlock();
+    return true;
+}
+
+std::shared_ptr<const HostedDatabase> PIRRegistry::Find(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = databases_.find(name);
+    return (it == databases_.end()) ? nullptr : it->second;
+}
+
+bool PIRRegistry::Answer(const std::string& name, const Matrix& ct, Matrix& ans, uint64_t* epoch) const {
+    std::shared_ptr<const HostedDatabase> hosted = Find(name);
+    if (!hosted) {
+        std::cerr << "Error: unknown database '" << name << "'" << std::endl;
+        return false;
+    }
+
+    Answer(*hosted, ct, ans);
+    if (epoch) {
+        *epoch = hosted->epoch;
+    }
+    return true;
+}
+
+void PIRRegistry::Answer(const HostedDatabase& snapshot, const Matrix& ct, Matrix& ans) const {
+    snapshot.inFlight++;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    ans = snapshot.kernels.answer(snapshot.D, ct, numThreads_);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    snapshot.inFlight--;
+
+    snapshot.metrics.queries++;
+    snapshot.metrics.answerMicros += micros;
+    snapshot.metrics.lastAnswerMicros = micros;
+}
+
+std::vector<std::string> PIRRegistry::Names() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<std::string> names;
+    for (const auto& entry : databases_) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+uint64_t PIRRegistry::NumPublicMatrices() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return publicMatrices_.size();
+}
+
+std::vector<RetiredEpoch> PIRRegistry::RetiredEpochs() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<RetiredEpoch> alive;
+    for (const auto& old : retired_) {
+        if (std::shared_ptr<const HostedDatabase> db = old.lock()) {
+            alive.push_back({db->name, db->epoch, db->inFlight});
+        }
+    }
+    return alive;
+}
+
+void PIRRegistry::PrintMetrics(std::ostream& out) const {
+    std::vector<RetiredEpoch> retired = RetiredEpochs();
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    out << "Databases: " << databases_.size() << ", public matrices: " << publicMatrices_.size() << std::endl;
+    for (const auto& entry : databases_) {
+        const HostedDatabase& db = *entry.second;
+        uint64_t queries = db.metrics.queries;
+        double total = db.metrics.answerMicros / 1000.0;
+        out << "  " << db.name << ": epoch " << db.epoch
+            << ", " << db.size << " x " << db.pir->dbParams.d << " bits";
+        if (db.size < db.pir->N) {
+            DBLayout layout = DBLayout::fromParams(db.pir->dbParams);
+            out << " (" << (db.pir->N - db.size) << " reserved slots, "
+                << (db.pir->dbParams.m - 1 - layout.columnOf(db.size - 1)) << " spare columns)";
+        }
+        out << " (m=" << db.pir->dbParams.m << ")"
+            << ", " << queries << " queries"
+            << ", " << (queries ? total / queries : 0.0) << " ms/answer" << std::endl;
+    }
+    if (swaps_ > 0) {
+        out << "Epoch swaps: " << swaps_ << " (lock held at most " << maxSwapMicros_ << " us), "
+            << retired.size() << " retired epoch(s) still referenced" << std::endl;
+        for (const RetiredEpoch& old : retired) {
+            out << "  " << old.name << ": epoch " << old.epoch << ", " << old.inFlight << " answer(s) in flight" << std::endl;
+        }
+    }
+}
+
+// ============================================================================
+// Registry pipeline
+// ============================================================================
+
+/**
+ * Reads the tenant columns of filePath, all of the same length
+ */
+static bool readTenantColumns(const std::string& filePath, const std::vector<std::string>& columns,
+                              bool hasHeader, std::vector<std::vector<uint64_t>>& values) {
+    values.clear();
+    bool loaded = (detectFileFormat(filePath) == FileFormat::PARQUET)
+        ? readParquetColumns(values, filePath, columns)
+        : readCSVColumns(values, filePath, columns, hasHeader);
+    if (!loaded || values.empty() || values[0].empty()) {
+        std::cerr << "Error: no data found in " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * PIR instance holding one column (d inferred from its maximum)
+ */
+static std::unique_ptr<VLHEPIR> makeTenant(const std::vector<uint64_t>& values, const PIRConfig& config) {
+    uint64_t N = values.size();
+    uint64_t d = calculateBitSize(*std::max_element(values.begin(), values.end()));
+    std::unique_ptr<VLHEPIR> pir(new VLHEPIR(N, d, config.allowTrivial, config.verbose, config.simplePIR,
+                                             false, config.batchSize, config.honestHint));
+    if (!pir->db.alloc) {
+        pir->db.data = (entry_t*)malloc(N * sizeof(entry_t));
+        pir->db.alloc = true;
+    }
+    selectKernels(d, 0).load(pir->db, 0, values.data(), N);
+    return pir;
+}
+
+/**
+ * Latency of the requests served in one phase of a live reload
+ */
+struct ReloadPhase {
+    uint64_t queries = 0;
+    double totalMs = 0;
+    double maxMs = 0;
+};
+
+/**
+ * Loads filePath again as the next epoch of every tenant, in the
+ * background, while a client keeps querying all of them
+ */
+static bool runLiveReload(PIRRegistry& registry, const std::string& filePath,
+                          const std::vector<std::string>& columns, uint64_t queryIndex,
+                          bool hasHeader, const PIRConfig& config) {
+    std::cout << "--- Live reload ---" << std::endl;
+    enum { BEFORE, REBUILDING, AFTER };
+    std::atomic<int> phase{BEFORE};
+    std::atomic<uint64_t> served{0};
+    std::atomic<bool> stop{false};
+    ReloadPhase phases[3];
+    std::set<uint64_t> epochs;
+    uint64_t mismatches = 0;
+    uint64_t failures = 0;
+
+    // The client pins the epoch whose hint it holds: the snapshot it looked
+    // up answers its query and decodes it, even if a swap happens meanwhile
+    std::thread client([&]() {
+        while (!stop) {
+            for (const std::string& name : columns) {
+                int current = phase;
+                auto start_time = std::chrono::high_resolution_clock::now();
+                std::shared_ptr<const HostedDatabase> snapshot = registry.Find(name);
+                if (!snapshot) {
+                    // Not hosted at this instant: the request fails
+                    failures++;
+                    served++;
+                    continue;
+                }
+                auto ct_sk = snapshot->pir->Query(*snapshot->A, queryIndex);
+                Matrix ans;
+                registry.Answer(*snapshot, std::get<0>(ct_sk), ans);
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+                entry_t result = snapshot->pir->Recover(snapshot->H, ans, std::get<1>(ct_sk), queryIndex);
+                mismatches += (result == snapshot->pir->db.getDataAtIndex(queryIndex)) ? 0 : 1;
+                epochs.insert(snapshot->epoch);
+
+                ReloadPhase& stats = phases[current];
+                stats.queries++;
+                stats.totalMs += elapsed.count();
+                stats.maxMs = std::max(stats.maxMs, elapsed.count());
+                served++;
+            }
+        }
+    });
+    auto waitForQueries = [&](uint64_t count) {
+        uint64_t target = served + count;
+        while (served < target) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+
+    waitForQueries(4 * columns.size());
+    phase = REBUILDING;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<std::vector<uint64_t>> values;
+    bool ok = readTenantColumns(filePath, columns, hasHeader, values);
+    if (ok && queryIndex >= values[0].size()) {
+        std::cerr << "Error: query index " << queryIndex << " out of bounds after reload (max: "
+                  << (values[0].size() - 1) << ")" << std::endl;
+        ok = false;
+    }
+    std::vector<std::future<uint64_t>> next;
+    for (uint64_t k = 0; ok && k < columns.size(); k++) {
+        next.push_back(registry.RegisterAsync(columns[k], makeTenant(values[k], config)));
+    }
+    for (std::future<uint64_t>& epoch : next) {
+        epoch.get();
+    }
+    std::chrono::duration<double, std::milli> rebuild = std::chrono::high_resolution_clock::now() - start_time;
+    phase = AFTER;
+    waitForQueries(4 * columns.size());
+    stop = true;
+    client.join();
+
+    std::cout << "Next epoch of " << columns.size() << " database(s) built in " << rebuild.count()
+              << " ms while serving" << std::endl;
+    const char* labels[3] = {"before", "rebuilding", "after swap"};
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::left << std::setw(14) << "" << std::right << std::setw(10) << "queries"
+              << std::setw(12) << "avg (ms)" << std::setw(12) << "max (ms)" << std::endl;
+    for (int i = BEFORE; i <= AFTER; i++) {
+        const ReloadPhase& stats = phases[i];
+        std::cout << std::left << std::setw(14) << labels[i] << std::right << std::setw(10) << stats.queries
+                  << std::setw(12) << (stats.queries ? stats.totalMs / stats.queries : 0.0)
+                  << std::setw(12) << stats.maxMs << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+    std::cout << "Epochs answered:";
+    for (uint64_t epoch : epochs) {
+        std::cout << " " << epoch;
+    }
+    std::cout << ", " << mismatches << " wrong answer(s), " << failures << " failed request(s)" << std::endl;
+    return ok && mismatches == 0 && failures == 0;
+}
+
+bool runRegistryPIR(const std::string& filePath,
+                    const std::vector<std::string>& columns,
+                    uint64_t queryIndex,
+                    bool hasHeader,
+                    const PIRConfig& config,
+                    bool reload) {
+    std::cout << "=== Multi-database server ===" << std::endl;
+    std::vector<std::vector<uint64_t>> values;
+    if (!readTenantColumns(filePath, columns, hasHeader, values)) {
+        return false;
+    }
+    uint64_t N = values[0].size();
+    if (queryIndex >= N) {
+        std::cerr << "Error: query index " << queryIndex << " out of bounds (max: " << (N - 1) << ")" << std::endl;
+        return false;
+    }
+
+    PIRRegistry registry;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (uint64_t k = 0; k < columns.size(); k++) {
+        registry.Register(columns[k], makeTenant(values[k], config));
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    std::cout << "Offline phase (" << columns.size() << " databases): " << duration.count() << " ms" << std::endl;
+
+    // Client side: one query per database, routed by name
+    bool ok = true;
+    for (const std::string& name : columns) {
+        std::shared_ptr<const HostedDatabase> hosted = registry.Find(name);
+        auto ct_sk = hosted->pir->Query(*hosted->A, queryIndex);
+        Matrix ans;
+        uint64_t epoch = 0;
+        if (!registry.Answer(name, std::get<0>(ct_sk), ans, &epoch)) {
+            return false;
+        }
+        entry_t result = hosted->pir->Recover(hosted->H, ans, std::get<1>(ct_sk), queryIndex);
+        bool match = (result == hosted->pir->db.getDataAtIndex(queryIndex));
+        std::cout << "  " << name << "[" << queryIndex << "] = " << result.toUnsignedLong()
+                  << " (epoch " << epoch << ")" << (match ? "" : " (mismatch)") << std::endl;
+        ok = ok && match;
+    }
+
+    if (ok && reload) {
+        ok = runLiveReload(registry, filePath, columns, queryIndex, hasHeader, config);
+    }
+    registry.PrintMetrics(std::cout);
+    return ok;
+}
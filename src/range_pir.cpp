@@ -0,0 +1,114 @@
+#include "range_pir.h"
+#include "data_loader.h"
+#include "pir_kernels.h"
+#include <chrono>
+#include <iostream>
+
+// ============================================================================
+// Prefix-sum database
+// ============================================================================
+
+bool computePrefixSums(const std::vector<uint64_t>& values, std::vector<uint64_t>& prefix) {
+    prefix.assign(values.size() + 1, 0);
+    for (uint64_t i = 0; i < values.size(); i++) {
+        if (values[i] > UINT64_MAX - prefix[i]) {
+            return false;
+        }
+        prefix[i + 1] = prefix[i] + values[i];
+    }
+    return true;
+}
+
+VLHEPIR createPrefixSumVLHEPIR(const std::vector<uint64_t>& prefix, uint64_t& prefixD, const PIRConfig& config) {
+    prefixD = calculateBitSize(prefix.back());
+
+    VLHEPIR pir(prefix.size(), prefixD, config.allowTrivial, config.verbose, config.simplePIR,
+                false, config.batchSize, config.honestHint);
+    if (pir.db.alloc) {
+        free(pir.db.data);
+    }
+    pir.db.data = (entry_t*)malloc(pir.N * sizeof(entry_t));
+    pir.db.alloc = true;
+    for (uint64_t i = 0; i < pir.N; i++) {
+        pir.db.data[i] = entry_t(static_cast<unsigned long>(prefix[i]));
+    }
+    return pir;
+}
+
+// ============================================================================
+// Range-sum queries
+// ============================================================================
+
+Matrix RangeSumClient::Query(VLHEPIR& pir, const Matrix& A, uint64_t lo, uint64_t hi) {
+    positions_[0] = lo;
+    positions_[1] = hi + 1;
+
+    Matrix ct(A.rows, 2);
+    for (uint64_t j = 0; j < 2; j++) {
+        auto ct_sk = pir.Query(A, positions_[j]);
+        const Matrix& ct_j = std::get<0>(ct_sk);
+        for (uint64_t r = 0; r < ct_j.rows; r++) {
+            ct.data[r * 2 + j] = ct_j.data[r];
+        }
+        sks_[j] = std::get<1>(ct_sk);
+    }
+    return ct;
+}
+
+uint64_t RangeSumClient::Recover(VLHEPIR& pir, const Matrix& H, const Matrix& ans) const {
+    uint64_t sums[2];
+    for (uint64_t j = 0; j < 2; j++) {
+        Matrix ans_j(ans.rows, 1);
+        for (uint64_t r = 0; r < ans.rows; r++) {
+            ans_j.data[r] = ans.data[r * 2 + j];
+        }
+        sums[j] = pir.Recover(H, ans_j, sks_[j], positions_[j]).toUnsignedLong();
+    }
+    return sums[1] - sums[0];
+}
+
+bool runRangeSumPIR(const std::vector<uint64_t>& values, uint64_t lo, uint64_t hi, const PIRConfig& config) {
+    std::cout << "=== Range-Sum PIR ===" << std::endl;
+    if (lo > hi || hi >= values.size()) {
+        std::cerr << "Error: invalid range [" << lo << ", " << hi << "] (max index: " << (values.size() - 1) << ")" << std::endl;
+        return false;
+    }
+
+    std::vector<uint64_t> prefix;
+    if (!computePrefixSums(values, prefix)) {
+        std::cerr << "Error: the sum of all values exceeds 64 bits, prefix sums cannot be stored" << std::endl;
+        return false;
+    }
+    uint64_t prefixD = 0;
+    VLHEPIR pir = createPrefixSumVLHEPIR(prefix, prefixD, config);
+    std::cout << "Prefix-sum database: " << pir.N << " entries of " << prefixD << " bits" << std::endl;
+    std::cout << "Database parameters: ";
+    pir.dbParams.print();
+
+    // Offline phase
+    Matrix D = pir.db.packDataInMatrix(pir.dbParams, false);
+    PIRKernels kernels = selectKernels(pir.dbParams);
+    KernelMatrix D_packed = kernels.pack(D);
+    Matrix A = pir.Init();
+    Matrix H = pir.GenerateHint(A, D);
+
+    // Online phase: both endpoints in one batched scan
+    RangeSumClient client;
+    Matrix ct = client.Query(pir, A, lo, hi);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    Matrix ans = kernels.answer(D_packed, ct);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    std::cout << "Answer time (2 point queries, one scan): " << duration.count() << " ms" << std::endl;
+
+    uint64_t sum = client.Recover(pir, H, ans);
+
+    uint64_t expected = 0;
+    for (uint64_t i = lo; i <= hi; i++) {
+        expected += values[i];
+    }
+    std::cout << "Sum over [" << lo << ", " << hi << "]: " << sum 
+              << " (expected: " << expected << ")" << std::endl;
+    return sum == expected;
+}
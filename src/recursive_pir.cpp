@@ -0,0 +1,323 @@
+#include "recursive_pir.h"
+#include "batch_pir.h"
+#include "data_loader.h"
+#include "pir_client.h"
+#include "util.h"
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// q = 2^logq is the ciphertext modulus (Elem arithmetic wraps around)
+static const uint64_t kLogQ = 8 * sizeof(Elem);
+
+// Level-2 error distribution: rounded Gaussian of this standard deviation,
+// bounded by kErrorTail standard deviations when choosing p2
+static const double kErrorStdDev = 6.4;
+static const double kErrorTail = 6.0;
+
+// ============================================================================
+// Communication planner
+// ============================================================================
+
+RecursionPlan planRecursion(const DBParams& params, uint64_t n) {
+    RecursionPlan plan;
+    plan.level1 = DBLayout::fromParams(params);
+    plan.n = n;
+
+    // Decoding a level-2 digit adds sum_r D2[i][r] * e[r] < p2 * tail * sigma * sqrt(ell1),
+    // which must stay below q / (2 p2)
+    const uint64_t ell1 = params.ell;
+    double bound = std::ldexp(1.0, kLogQ) / (2.0 * kErrorTail * kErrorStdDev * std::sqrt(double(ell1)));
+    plan.digitBits = 1;
+    while (plan.digitBits < 16 && std::ldexp(1.0, 2 * (plan.digitBits + 1)) <= bound) {
+        plan.digitBits++;
+    }
+    plan.p2 = 1ULL << plan.digitBits;
+    plan.kappa = (kLogQ + plan.digitBits - 1) / plan.digitBits;
+    plan.rows2 = (1 + n) * plan.kappa;
+
+    const uint64_t elemBytes = sizeof(Elem);
+    plan.single.hintBytes = ell1 * n * elemBytes;
+    plan.single.uploadBytes = params.m * elemBytes;
+    plan.single.downloadBytes = ell1 * elemBytes;
+
+    plan.recursive.hintBytes = n * plan.kappa * n * elemBytes;
+    plan.recursive.uploadBytes = (params.m + ell1) * elemBytes;
+    plan.recursive.downloadBytes = (plan.rows2 + plan.kappa * n) * elemBytes;
+    return plan;
+}
+
+void RecursionPlan::print(std::ostream& out, uint64_t queries) const {
+    out << "Recursion plan (ell1=" << level1.ell << ", m1=" << level1.m << ", n=" << n
+        << ", p2=2^" << digitBits << ", " << kappa << " digits per element):" << std::endl;
+    out << "  Single level: hint " << formatBytes(single.hintBytes)
+        << ", upload " << formatBytes(single.uploadBytes)
+        << ", download " << formatBytes(single.downloadBytes) << std::endl;
+    out << "  Two levels:   hint " << formatBytes(recursive.hintBytes)
+        << ", upload " << formatBytes(recursive.uploadBytes)
+        << ", download " << formatBytes(recursive.downloadBytes) << std::endl;
+    out << "  Online (per query): recursion " << (winsOnline() ? "wins" : "loses")
+        << " (" << formatBytes(recursive.online()) << " vs " << formatBytes(single.online()) << ")" << std::endl;
+    out << "  Total for " << queries << " quer" << (queries == 1 ? "y" : "ies") << ": recursion "
+        << (winsTotal(queries) ? "wins" : "loses")
+        << " (" << formatBytes(recursive.total(queries)) << " vs " << formatBytes(single.total(queries)) << ")" << std::endl;
+}
+
+// ============================================================================
+// Second level
+// ============================================================================
+
+/**
+ * Digit j of value in base p2
+ */
+static inline Elem digitOf(Elem value, uint64_t j, uint64_t digitBits) {
+    return (uint64_t(value) >> (j * digitBits)) & ((1ULL << digitBits) - 1);
+}
+
+Matrix expandPublicMatrix(const uint8_t* seed, uint64_t rows, uint64_t cols) {
+    Matrix A(rows, cols);
+    uint8_t* out = reinterpret_cast<uint8_t*>(A.data);
+    const uint64_t bytes = rows * cols * sizeof(Elem);
+    memset(out, 0, bytes);
+
+    // Keystream = encryption of zeros, in chunks that keep the length within int
+    const uint8_t iv[16] = {0};
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    EVP_EncryptInit_ex(ctx, EVP_aes_128_ctr(), nullptr, seed, iv);
+    const uint64_t maxChunk = 1ULL << 30;
+    for (uint64_t done = 0; done < bytes; done += maxChunk) {
+        int len = 0;
+        int chunk = static_cast<int>(std::min(maxChunk, bytes - done));
+        EVP_EncryptUpdate(ctx, out + done, &len, out + done, chunk);
+    }
+    EVP_CIPHER_CTX_free(ctx);
+    return A;
+}
+
+SecondLevelServer::SecondLevelServer(const RecursionPlan& plan, const Matrix& H1)
+    : plan_(plan), H2_(plan.n * plan.kappa, plan.n) {
+    const uint64_t ell1 = H1.rows;
+    const uint64_t n = plan.n;
+    const uint64_t kappa = plan.kappa;
+
+    RAND_bytes(seed_, sizeof(seed_));
+    A2_ = expandPublicMatrix(seed_, ell1, n);
+
+    // Static rows: digit j of H1[r][k] at row k * kappa + j, column r
+    Matrix D2(n * kappa, ell1);
+    for (uint64_t r = 0; r < ell1; r++) {
+        for (uint64_t k = 0; k < n; k++) {
+            Elem h = H1.data[r * H1.cols + k];
+            for (uint64_t j = 0; j < kappa; j++) {
+                D2.data[(k * kappa + j) * ell1 + r] = digitOf(h, j, plan.digitBits);
+            }
+        }
+    }
+    kernels_ = selectKernels(0, plan.p2);
+    D2_ = kernels_.pack(D2);
+
+    // H2 = D2 * A2, split across threads by rows
+    memset(H2_.data, 0, H2_.rows * H2_.cols * sizeof(Elem));
+    auto hintRows = [&](uint64_t begin, uint64_t end) {
+        for (uint64_t i = begin; i < end; i++) {
+            Elem* out = H2_.data + i * n;
+            const Elem* row = D2.data + i * ell1;
+            for (uint64_t r = 0; r < ell1; r++) {
+                Elem coeff = row[r];
+                if (coeff == 0) continue;
+                const Elem* a = A2_.data + r * n;
+                for (uint64_t c = 0; c < n; c++) {
+                    out[c] += coeff * a[c];
+                }
+            }
+        }
+    };
+    uint64_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t rowsPerThread = (D2.rows + numThreads - 1) / numThreads;
+    std::vector<std::thread> workers;
+    for (uint64_t t = 0; t < numThreads; t++) {
+        uint64_t begin = t * rowsPerThread;
+        uint64_t end = std::min<uint64_t>(D2.rows, begin + rowsPerThread);
+        if (begin >= end) break;
+        workers.emplace_back(hintRows, begin, end);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void SecondLevelServer::Answer(const Matrix& ans1, const Matrix& ct2, Matrix& ans2, Matrix& answerHint) const {
+    const uint64_t ell1 = A2_.rows;
+    const uint64_t n = plan_.n;
+    const uint64_t kappa = plan_.kappa;
+
+    ans2 = Matrix(plan_.rows2, 1);
+    answerHint = Matrix(kappa, n);
+    memset(answerHint.data, 0, kappa * n * sizeof(Elem));
+
+    // Rows depending on ans1: its digits times ct2 and times A2
+    for (uint64_t j = 0; j < kappa; j++) {
+        Elem acc = 0;
+        Elem* hint = answerHint.data + j * n;
+        for (uint64_t r = 0; r < ell1; r++) {
+            Elem digit = digitOf(ans1.data[r], j, plan_.digitBits);
+            if (digit == 0) continue;
+            acc += digit * ct2.data[r];
+            const Elem* a = A2_.data + r * n;
+            for (uint64_t c = 0; c < n; c++) {
+                hint[c] += digit * a[c];
+            }
+        }
+        ans2.data[j] = acc;
+    }
+
+    // Static rows: the packed digits of H1
+    Matrix rest = kernels_.answer(D2_, ct2);
+    memcpy(ans2.data + kappa, rest.data, rest.rows * sizeof(Elem));
+}
+
+// ============================================================================
+// Client
+// ============================================================================
+
+/**
+ * Rounded Gaussian samples (Box-Muller over OpenSSL random bytes)
+ */
+static std::vector<int64_t> sampleErrors(uint64_t count) {
+    std::vector<uint64_t> uniform(count + 1);
+    RAND_bytes(reinterpret_cast<uint8_t*>(uniform.data()), uniform.size() * sizeof(uint64_t));
+    std::vector<int64_t> errors(count);
+    for (uint64_t i = 0; i < count; i += 2) {
+        double u1 = (uniform[i] >> 11) * 0x1.0p-53 + 0x1.0p-54;
+        double u2 = (uniform[i + 1] >> 11) * 0x1.0p-53;
+        double radius = kErrorStdDev * std::sqrt(-2.0 * std::log(u1));
+        errors[i] = std::llround(radius * std::cos(2 * M_PI * u2));
+        if (i + 1 < count) {
+            errors[i + 1] = std::llround(radius * std::sin(2 * M_PI * u2));
+        }
+    }
+    return errors;
+}
+
+Matrix RecursivePIRClient::Query(const Matrix& A2, uint64_t row) {
+    const uint64_t ell1 = A2.rows;
+    const uint64_t n = plan_.n;
+
+    sk2_ = Matrix(n, 1);
+    RAND_bytes(reinterpret_cast<uint8_t*>(sk2_.data), n * sizeof(Elem));
+    std::vector<int64_t> errors = sampleErrors(ell1);
+
+    // ct2 = A2 * sk2 + e + (q / p2) * u_row
+    Matrix ct2(ell1, 1);
+    const Elem delta = Elem(1) << (kLogQ - plan_.digitBits);
+    for (uint64_t r = 0; r < ell1; r++) {
+        const Elem* a = A2.data + r * n;
+        Elem acc = static_cast<Elem>(errors[r]);
+        for (uint64_t c = 0; c < n; c++) {
+            acc += a[c] * sk2_.data[c];
+        }
+        ct2.data[r] = (r == row) ? acc + delta : acc;
+    }
+    return ct2;
+}
+
+entry_t RecursivePIRClient::Recover(const Matrix& H2, const Matrix& ans2, const Matrix& answerHint,
+                                    const Matrix& sk1, uint64_t index) const {
+    const uint64_t n = plan_.n;
+    const uint64_t kappa = plan_.kappa;
+    auto combine = [&](const std::vector<uint64_t>& digits, uint64_t first) {
+        Elem value = 0;
+        for (uint64_t j = 0; j < kappa; j++) {
+            value += Elem(digits[first + j]) << (j * plan_.digitBits);
+        }
+        return value;
+    };
+
+    // Level 2: the level-1 answer element and hint row of the queried row
+    Matrix ansHead(kappa, 1), ansTail(n * kappa, 1);
+    memcpy(ansHead.data, ans2.data, kappa * sizeof(Elem));
+    memcpy(ansTail.data, ans2.data + kappa, n * kappa * sizeof(Elem));
+    std::vector<uint64_t> headDigits = DecodeDigits(answerHint, ansHead, sk2_, plan_.p2);
+    std::vector<uint64_t> tailDigits = DecodeDigits(H2, ansTail, sk2_, plan_.p2);
+
+    Matrix ans1(1, 1), h1(1, n);
+    ans1.data[0] = combine(headDigits, 0);
+    for (uint64_t k = 0; k < n; k++) {
+        h1.data[k] = combine(tailDigits, k * kappa);
+    }
+
+    // Level 1: the Z_p digit, then the entry inside it
+    uint64_t digit = DecodeDigits(h1, ans1, sk1, plan_.level1.p)[0];
+    uint64_t mask = (plan_.level1.d >= 64) ? UINT64_MAX : ((1ULL << plan_.level1.d) - 1);
+    return entry_t(static_cast<unsigned long>((digit >> plan_.level1.bitOffsetOf(index)) & mask));
+}
+
+// ============================================================================
+// Two-level pipeline
+// ============================================================================
+
+bool runRecursivePIR(VLHEPIR& pir, uint64_t queryIndex, uint64_t queries) {
+    std::cout << "=== Recursive PIR ===" << std::endl;
+    if (queryIndex >= pir.N) {
+        std::cerr << "Error: query index " << queryIndex << " out of bounds (max: " << (pir.N - 1) << ")" << std::endl;
+        return false;
+    }
+    if (!pir.db.alloc) {
+        fillRandomDatabase(pir.db, pir.dbParams.d, queryIndex);
+    }
+
+    // Level 1 offline phase
+    auto start_time = std::chrono::high_resolution_clock::now();
+    Matrix D1 = pir.db.packDataInMatrix(pir.dbParams, false);
+    PIRKernels kernels = selectKernels(pir.dbParams);
+    KernelMatrix D1_packed = kernels.pack(D1);
+    Matrix A1 = pir.Init();
+    Matrix H1 = pir.GenerateHint(A1, D1);
+
+    RecursionPlan plan = planRecursion(pir.dbParams, H1.cols);
+    plan.print(std::cout, queries);
+    if (plan.level1.elemsPerEntry > 1) {
+        std::cerr << "Error: recursive mode needs entries of at most log2 p = " 
+                  << plan.level1.bitsPerElem << " bits" << std::endl;
+        return false;
+    }
+
+    // Level 2 offline phase: digits of H1 and their hint
+    SecondLevelServer server(plan, H1);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    std::cout << "Offline phase (both levels): " << duration.count() << " ms" << std::endl;
+
+    // Online phase, A2 expanded from the seed published with H2
+    RecursivePIRClient client(plan);
+    Matrix A2 = expandPublicMatrix(server.seed(), H1.rows, plan.n);
+    auto ct_sk = pir.Query(A1, queryIndex);
+    Matrix ct2 = client.Query(A2, plan.level1.rowOf(queryIndex));
+
+    start_time = std::chrono::high_resolution_clock::now();
+    Matrix ans1 = kernels.answer(D1_packed, std::get<0>(ct_sk));
+    Matrix ans2, answerHint;
+    server.Answer(ans1, ct2, ans2, answerHint);
+    end_time = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    std::cout << "Answer time (both levels): " << duration.count() << " ms" << std::endl;
+
+    entry_t result = client.Recover(server.hint(), ans2, answerHint, std::get<1>(ct_sk), queryIndex);
+
+    const uint64_t elemBytes = sizeof(Elem);
+    std::cout << "Exchanged: hint " << formatBytes(server.hint().rows * server.hint().cols * elemBytes + A2_SEED_BYTES)
+              << " (vs " << formatBytes(H1.rows * H1.cols * elemBytes) << "), upload "
+              << formatBytes((std::get<0>(ct_sk).rows + ct2.rows) * elemBytes) << ", download "
+              << formatBytes((ans2.rows + answerHint.rows * answerHint.cols) * elemBytes)
+              << " (vs " << formatBytes(ans1.rows * elemBytes) << ")" << std::endl;
+
+    entry_t expected = pir.db.getDataAtIndex(queryIndex);
+    std::cout << "Recovered value: " << result.toUnsignedLong() 
+              << " (expected: " << expected.toUnsignedLong() << ")" << std::endl;
+    return result == expected;
+}
@@ -0,0 +1,179 @@
+#include "sharded_pir.h"
+#include "data_loader.h"
+#include "pir_client.h"
+#include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+void shardRows(uint64_t rows, uint64_t numShards, uint64_t shard, uint64_t& firstRow, uint64_t& count) {
+    firstRow = rows * shard / numShards;
+    count = rows * (shard + 1) / numShards - firstRow;
+}
+
+// ============================================================================
+// Shard server process
+// ============================================================================
+
+bool ShardServerProcess::Start(const PIRKernels& kernels, const KernelMatrix& D, uint64_t firstRow,
+                               uint64_t rows, uint64_t numThreads) {
+    firstRow_ = firstRow;
+    rows_ = rows;
+    sliceBytes_ = rows * D.wordsPerRow * sizeof(uint64_t);
+
+    // Shard: (rows, cols, ct) in, (rows, cols, scan time, answer) out, until EOF
+    return process_.Start("shard", [&](int requests, int replies) {
+        KernelMatrix slice;
+        slice.rows = rows;
+        slice.cols = D.cols;
+        slice.logp = D.logp;
+        slice.digitsPerWord = D.digitsPerWord;
+        slice.wordsPerRow = D.wordsPerRow;
+        const uint64_t* first = D.data() + firstRow * D.wordsPerRow;
+        slice.words.assign(first, first + rows * D.wordsPerRow);
+
+        uint64_t shape[2];
+        while (readAll(requests, shape, sizeof(shape))) {
+            Matrix ct(shape[0], shape[1]);
+            if (!readAll(requests, ct.data, ct.rows * ct.cols * sizeof(Elem)) || ct.rows != slice.cols) {
+                break;
+            }
+            auto start_time = std::chrono::high_resolution_clock::now();
+            std::vector<Elem> padded = padQuery(ct, slice.wordsPerRow * slice.digitsPerWord);
+            std::vector<Elem> ans(slice.rows * ct.cols);
+            kernels.answerBlock(ans.data(), slice, padded.data(), ct.cols, numThreads);
+            auto end_time = std::chrono::high_resolution_clock::now();
+            uint64_t reply[3] = {slice.rows, ct.cols,
+                                 uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count())};
+            if (!writeAll(replies, reply, sizeof(reply)) ||
+                !writeAll(replies, ans.data(), ans.size() * sizeof(Elem))) {
+                break;
+            }
+        }
+    });
+}
+
+bool ShardServerProcess::Send(const Matrix& ct) {
+    uint64_t shape[2] = {ct.rows, ct.cols};
+    return writeAll(process_.toChild(), shape, sizeof(shape)) &&
+           writeAll(process_.toChild(), ct.data, ct.rows * ct.cols * sizeof(Elem));
+}
+
+bool ShardServerProcess::Receive(ShardAnswer& answer) {
+    uint64_t reply[3];
+    if (!readAll(process_.fromChild(), reply, sizeof(reply)) || reply[0] != rows_) {
+        return false;
+    }
+    answer.firstRow = firstRow_;
+    answer.ans = Matrix(reply[0], reply[1]);
+    answer.scanMicros = reply[2];
+    return readAll(process_.fromChild(), answer.ans.data, reply[0] * reply[1] * sizeof(Elem));
+}
+
+void ShardServerProcess::Stop() {
+    process_.Stop();
+}
+
+// ============================================================================
+// Scaling benchmark
+// ============================================================================
+
+bool runShardedPIR(VLHEPIR& pir, uint64_t queryIndex, uint64_t maxShards, uint64_t threadsPerShard) {
+    std::cout << "=== Sharded Answer ===" << std::endl;
+    if (queryIndex >= pir.N) {
+        std::cerr << "Error: query index " << queryIndex << " out of bounds (max: " << (pir.N - 1) << ")" << std::endl;
+        return false;
+    }
+    if (!pir.db.alloc) {
+        fillRandomDatabase(pir.db, pir.dbParams.d, queryIndex);
+    }
+    const uint64_t iters = 5;
+
+    // Offline phase once, on the whole database
+    PIRKernels kernels = selectKernels(pir.dbParams);
+    Matrix D = pir.db.packDataInMatrix(pir.dbParams, false);
+    KernelMatrix D_packed = kernels.pack(D);
+    Matrix A = pir.Init();
+    Matrix H = kernels.hint(D_packed, A);
+    auto ct_sk = pir.Query(A, queryIndex);
+    const Matrix& ct = std::get<0>(ct_sk);
+    entry_t expected = pir.db.getDataAtIndex(queryIndex);
+
+    maxShards = std::min<uint64_t>(std::max<uint64_t>(maxShards, 1), std::max<uint64_t>(D_packed.rows, 1));
+    std::vector<uint64_t> counts;
+    for (uint64_t shards = 1; shards < maxShards; shards *= 2) {
+        counts.push_back(shards);
+    }
+    counts.push_back(maxShards);
+
+    std::cout << "Packed matrix: " << D_packed.rows << " x " << D_packed.cols << " ("
+              << D_packed.words.size() * sizeof(uint64_t) / double(1ULL << 20) << " MiB), "
+              << threadsPerShard << " thread(s) per shard" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(8) << "shards" << std::setw(14) << "slice (MiB)" << std::setw(14) << "latency (ms)"
+              << std::setw(16) << "slowest scan" << std::setw(10) << "speedup" << std::setw(12) << "efficiency" << std::endl;
+
+    bool correct = true;
+    double baseline = 0;
+    for (uint64_t numShards : counts) {
+        std::vector<ShardServerProcess> shards(numShards);
+        uint64_t sliceBytes = 0;
+        for (uint64_t s = 0; s < numShards; s++) {
+            uint64_t firstRow = 0, rows = 0;
+            shardRows(D_packed.rows, numShards, s, firstRow, rows);
+            if (!shards[s].Start(kernels, D_packed, firstRow, rows, threadsPerShard)) {
+                return false;
+            }
+            sliceBytes = std::max(sliceBytes, shards[s].sliceBytes());
+        }
+
+        // One warm-up round, then iters timed rounds; every round is recovered
+        double latencyMs = 0;
+        uint64_t slowestMicros = 0;
+        for (uint64_t i = 0; i <= iters; i++) {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            // Every shard scans concurrently, as separate boxes would
+            for (ShardServerProcess& shard : shards) {
+                if (!shard.Send(ct)) {
+                    std::cerr << "Error: shard process failed" << std::endl;
+                    return false;
+                }
+            }
+            std::vector<Matrix> partials;
+            uint64_t slowest = 0;
+            for (ShardServerProcess& shard : shards) {
+                ShardAnswer part;
+                if (!shard.Receive(part)) {
+                    std::cerr << "Error: shard process failed" << std::endl;
+                    return false;
+                }
+                slowest = std::max(slowest, part.scanMicros);
+                partials.push_back(std::move(part.ans));
+            }
+            Matrix ans = ConcatenateAnswers(partials);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+            correct = correct && ans.rows == H.rows && pir.Recover(H, ans, std::get<1>(ct_sk), queryIndex) == expected;
+            if (i > 0) {
+                latencyMs += elapsed.count() / iters;
+                slowestMicros += slowest / iters;
+            }
+        }
+        for (ShardServerProcess& shard : shards) {
+            shard.Stop();
+        }
+
+        if (numShards == 1) {
+            baseline = latencyMs;
+        }
+        double speedup = latencyMs > 0 ? baseline / latencyMs : 0;
+        std::cout << std::setw(8) << numShards << std::setw(14) << sliceBytes / double(1ULL << 20)
+                  << std::setw(14) << latencyMs << std::setw(13) << slowestMicros / 1000.0 << " ms"
+                  << std::setw(10) << speedup << std::setw(11) << 100.0 * speedup / numShards << "%" << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+    std::cout << "Value at index " << queryIndex << ": " << expected.toUnsignedLong() << ", recovered from the "
+              << "concatenated answers in " << (correct ? "every round" : "NOT every round") << std::endl;
+    return correct;
+}
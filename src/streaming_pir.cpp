@@ -0,0 +1,274 @@
+#include "streaming_pir.h"
+#include "data_loader.h"
+#include "util.h"
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// First 8 bytes of a packed matrix file
+static const char kPackedFileMagic[8] = {'P', 'I', 'R', 'K', 'M', 'A', 'T', '1'};
+
+// ============================================================================
+// Packed matrix file
+// ============================================================================
+
+bool writeKernelMatrix(const KernelMatrix& D, const std::string& path) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: unable to write " << path << std::endl;
+        return false;
+    }
+    std::vector<char> header(PACKED_FILE_DATA_OFFSET, 0);
+    uint64_t shape[5] = {D.rows, D.cols, D.logp, D.digitsPerWord, D.wordsPerRow};
+    memcpy(header.data(), kPackedFileMagic, sizeof(kPackedFileMagic));
+    memcpy(header.data() + sizeof(kPackedFileMagic), shape, sizeof(shape));
+    file.write(header.data(), header.size());
+    file.write(reinterpret_cast<const char*>(D.words.data()), D.words.size() * sizeof(uint64_t));
+    if (!file) {
+        std::cerr << "Error: write to " << path << " failed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool DiskKernelMatrix::open(const std::string& path, uint64_t blockBytes) {
+    path_ = path;
+    std::ifstream file(path, std::ios::binary);
+    char header[sizeof(kPackedFileMagic) + 5 * sizeof(uint64_t)];
+    if (!file.is_open()) {
+        std::cerr << "Error: unable to open " << path << std::endl;
+        return false;
+    }
+    if (!file.read(header, sizeof(header)) || memcmp(header, kPackedFileMagic, sizeof(kPackedFileMagic)) != 0) {
+        std::cerr << "Error: " << path << " is not a packed matrix file" << std::endl;
+        return false;
+    }
+    uint64_t shape[5];
+    memcpy(shape, header + sizeof(kPackedFileMagic), sizeof(shape));
+    shape_.rows = shape[0];
+    shape_.cols = shape[1];
+    shape_.logp = shape[2];
+    shape_.digitsPerWord = shape[3];
+    shape_.wordsPerRow = shape[4];
+
+    // With O_DIRECT a block must also be a whole number of pages
+    const uint64_t rowBytes = std::max<uint64_t>(shape_.wordsPerRow * sizeof(uint64_t), 1);
+    const uint64_t rowsPerPage = asyncReadDefaults().direct
+                               ? ASYNC_READ_ALIGNMENT / std::gcd(rowBytes, ASYNC_READ_ALIGNMENT) : 1;
+    blockRows_ = std::max<uint64_t>(blockBytes / rowBytes, 1);
+    blockRows_ = std::min(blockRows_, std::max<uint64_t>(shape_.rows, 1));
+    blockRows_ = (blockRows_ + rowsPerPage - 1) / rowsPerPage * rowsPerPage;
+    return true;
+}
+
+AsyncReadOptions DiskKernelMatrix::readOptions() const {
+    AsyncReadOptions options = asyncReadDefaults();
+    options.bufferBytes = blockRows_ * shape_.wordsPerRow * sizeof(uint64_t);
+    options.queueDepth = std::max<uint64_t>(options.queueDepth, 2);
+    return options;
+}
+
+double DiskKernelMatrix::dropCache() const {
+    int fd = ::open(path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    // Dirty pages (the file was just written) are not dropped: write them back first
+    fdatasync(fd);
+#ifdef POSIX_FADV_DONTNEED
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+
+    double resident = -1;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* map = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED) {
+            const uint64_t pageBytes = sysconf(_SC_PAGESIZE);
+            std::vector<unsigned char> pages((info.st_size + pageBytes - 1) / pageBytes);
+            if (mincore(map, info.st_size, pages.data()) == 0) {
+                uint64_t cached = 0;
+                for (unsigned char page : pages) {
+                    cached += page & 1;
+                }
+                resident = double(cached) / pages.size();
+            }
+            munmap(map, info.st_size);
+        }
+    }
+    close(fd);
+    return resident;
+}
+
+// ============================================================================
+// Streamed answer
+// ============================================================================
+
+bool DiskKernelMatrix::answer(const PIRKernels& kernels, const Matrix& ct, Matrix& ans,
+                              StreamStats* stats, uint64_t numThreads) const {
+    if (ct.rows != shape_.cols) {
+        std::cerr << "Error: query has " << ct.rows << " rows, database has "
+                  << shape_.cols << " columns" << std::endl;
+        return false;
+    }
+    if (kernels.logp != shape_.logp) {
+        std::cerr << "Error: kernels for log p = " << kernels.logp << ", file packed with log p = "
+                  << shape_.logp << std::endl;
+        return false;
+    }
+
+    const uint64_t batch = ct.cols;
+    std::vector<Elem> padded = padQuery(ct, shape_.wordsPerRow * shape_.digitsPerWord);
+    ans = Matrix(shape_.rows, batch);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    AsyncFileReader reader;
+    if (!reader.open(path_, readOptions(), PACKED_FILE_DATA_OFFSET, dataBytes())) {
+        return false;
+    }
+
+    // Each block is scanned in place, from the reader's buffer
+    KernelMatrix block = shape_;
+    const uint64_t rowBytes = shape_.wordsPerRow * sizeof(uint64_t);
+    uint64_t firstRow = 0, blocks = 0;
+    double computeSeconds = 0, stallSeconds = 0;
+    const char* data = nullptr;
+    uint64_t size = 0;
+    while (true) {
+        auto wait_start = std::chrono::high_resolution_clock::now();
+        bool more = reader.next(data, size);
+        stallSeconds += secondsSince(wait_start);
+        if (!more) break;
+
+        block.rows = size / rowBytes;
+        block.external = reinterpret_cast<const uint64_t*>(data);
+        auto compute_start = std::chrono::high_resolution_clock::now();
+        kernels.answerBlock(ans.data + firstRow * batch, block, padded.data(), batch, numThreads);
+        computeSeconds += secondsSince(compute_start);
+        firstRow += block.rows;
+        blocks++;
+    }
+    if (reader.failed() || firstRow != shape_.rows) {
+        std::cerr << "Error: streamed " << firstRow << " of " << shape_.rows << " rows of " << path_ << std::endl;
+        return false;
+    }
+
+    if (stats) {
+        stats->bytesRead = reader.bytesRead();
+        stats->blocks = blocks;
+        stats->seconds = secondsSince(start_time);
+        stats->computeSeconds = computeSeconds;
+        stats->stallSeconds = stallSeconds;
+        stats->backend = reader.backend();
+        stats->direct = reader.direct();
+    }
+    return true;
+}
+
+double DiskKernelMatrix::measureReadBandwidth() const {
+    AsyncFileReader reader;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    if (!reader.open(path_, readOptions(), PACKED_FILE_DATA_OFFSET, dataBytes())) {
+        return 0;
+    }
+    const char* data = nullptr;
+    uint64_t size = 0;
+    while (reader.next(data, size)) {
+    }
+    double seconds = secondsSince(start_time);
+    return (!reader.failed() && seconds > 0) ? reader.bytesRead() / seconds / 1e6 : 0;
+}
+
+// ============================================================================
+// Out-of-core pipeline
+// ============================================================================
+
+static void printStream(const char* label, const StreamStats& stats, double diskMBps) {
+    std::cout << label << ": " << stats.seconds * 1000 << " ms, " << stats.throughputMBps() << " MB/s";
+    if (diskMBps > 0) {
+        std::cout << " (" << 100.0 * stats.throughputMBps() / diskMBps << "% of the disk bandwidth)";
+    }
+    std::cout << std::endl;
+    std::cout << "  " << stats.blocks << " blocks, compute " << stats.computeSeconds * 1000
+              << " ms, waiting for reads " << stats.stallSeconds * 1000 << " ms" << std::endl;
+}
+
+bool runStreamingPIR(VLHEPIR& pir, uint64_t queryIndex, const std::string& path, uint64_t blockMiB) {
+    std::cout << "=== Out-of-core Answer ===" << std::endl;
+    if (queryIndex >= pir.N) {
+        std::cerr << "Error: query index " << queryIndex << " out of bounds (max: " << (pir.N - 1) << ")" << std::endl;
+        return false;
+    }
+    if (!pir.db.alloc) {
+        fillRandomDatabase(pir.db, pir.dbParams.d, queryIndex);
+    }
+
+    // Offline phase in memory; the packed matrix is freed once on disk
+    PIRKernels kernels = selectKernels(pir.dbParams);
+    Matrix A = pir.Init();
+    Matrix H;
+    {
+        Matrix D = pir.db.packDataInMatrix(pir.dbParams, false);
+        H = pir.GenerateHint(A, D);
+        KernelMatrix D_packed = kernels.pack(D);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        if (!writeKernelMatrix(D_packed, path)) {
+            return false;
+        }
+        std::cout << "Packed matrix written to " << path << " ("
+                  << D_packed.words.size() * sizeof(uint64_t) / double(1ULL << 20) << " MiB) in "
+                  << secondsSince(start_time) * 1000 << " ms" << std::endl;
+    }
+
+    DiskKernelMatrix disk;
+    if (!disk.open(path, blockMiB << 20)) {
+        return false;
+    }
+    std::cout << "Blocks of " << disk.blockRows() << " rows ("
+              << disk.blockRows() * disk.shape().wordsPerRow * sizeof(uint64_t) / double(1ULL << 20)
+              << " MiB), " << std::max<uint64_t>(asyncReadDefaults().queueDepth, 2) << " in flight" << std::endl;
+
+    // Read bandwidth of the file on its own, then the streamed scan, both
+    // cold unless the cached pages could not be dropped
+    auto reportDrop = [](double resident) {
+        if (resident < 0) {
+            std::cout << "Page cache drop: unverified" << std::endl;
+        } else if (resident > 0.01) {
+            std::cout << "Page cache drop: no effect, " << resident * 100
+                      << "% of the file still cached (numbers below are warm)" << std::endl;
+        } else {
+            std::cout << "Page cache drop: done" << std::endl;
+        }
+        return resident >= 0 && resident <= 0.01;
+    };
+    bool cold = reportDrop(disk.dropCache());
+    double diskMBps = disk.measureReadBandwidth();
+    std::cout << (cold ? "Disk" : "Cached") << " read bandwidth: " << diskMBps << " MB/s" << std::endl;
+
+    auto ct_sk = pir.Query(A, queryIndex);
+    Matrix ans;
+    StreamStats stats;
+    cold = reportDrop(disk.dropCache());
+    if (!disk.answer(kernels, std::get<0>(ct_sk), ans, &stats)) {
+        return false;
+    }
+    std::cout << "Reader: " << stats.backend << (stats.direct ? ", O_DIRECT" : "") << std::endl;
+    printStream(cold ? "Streamed answer (cold)" : "Streamed answer (cache not dropped)", stats, diskMBps);
+    if (!disk.answer(kernels, std::get<0>(ct_sk), ans, &stats)) {
+        return false;
+    }
+    printStream("Streamed answer (page cache)", stats, 0);
+
+    entry_t result = pir.Recover(H, ans, std::get<1>(ct_sk), queryIndex);
+    entry_t expected = pir.db.getDataAtIndex(queryIndex);
+    std::cout << "Recovered value: " << result.toUnsignedLong()
+              << " (expected: " << expected.toUnsignedLong() << ")" << std::endl;
+    return result == expected;
+}
@@ -0,0 +1,236 @@
+#include "two_server_pir.h"
+#include "data_loader.h"
+#include "pir_kernels.h"
+#include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// ============================================================================
+// Bit-sliced database
+// ============================================================================
+
+BitSlicedDatabase BitSlicedDatabase::fromDatabase(const Database& db, uint64_t d) {
+    if (d > 64) {
+        std::cerr << "Error: the two-server engine supports d <= 64 (got " << d << ")" << std::endl;
+        exit(1);
+    }
+    BitSlicedDatabase sliced;
+    sliced.N = db.N;
+    sliced.d = d;
+    sliced.numWords = (db.N + 63) / 64;
+    sliced.slices.assign(sliced.numWords * d, 0);
+
+    for (uint64_t i = 0; i < db.N; i++) {
+        uint64_t value = db.data[i].toUnsignedLong();
+        uint64_t* planes = sliced.slices.data() + (i / 64) * d;
+        uint64_t bit = 1ULL << (i % 64);
+        while (value) {
+            planes[__builtin_ctzll(value)] |= bit;
+            value &= value - 1;
+        }
+    }
+    return sliced;
+}
+
+/**
+ * Per-plane XOR-AND accumulation over words [begin, end)
+ */
+static void sliceRange(const BitSlicedDatabase& db, const uint64_t* selection,
+                       uint64_t begin, uint64_t end, uint64_t* acc) {
+    const uint64_t d = db.d;
+    memset(acc, 0, d * sizeof(uint64_t));
+    for (uint64_t w = begin; w < end; w++) {
+        uint64_t select = selection[w];
+        const uint64_t* planes = db.slices.data() + w * d;
+        for (uint64_t j = 0; j < d; j++) {
+            acc[j] ^= select & planes[j];
+        }
+    }
+}
+
+uint64_t BitSlicedDatabase::answer(const std::vector<uint64_t>& selection, uint64_t numThreads) const {
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numThreads = std::min<uint64_t>(numThreads, std::max<uint64_t>(numWords, 1));
+
+    std::vector<uint64_t> partial(numThreads * 64, 0);
+    std::vector<std::thread> workers;
+    uint64_t wordsPerThread = (numWords + numThreads - 1) / numThreads;
+    for (uint64_t t = 0; t < numThreads; t++) {
+        uint64_t begin = t * wordsPerThread;
+        uint64_t end = std::min(numWords, begin + wordsPerThread);
+        if (begin >= end) break;
+        workers.emplace_back(sliceRange, std::cref(*this), selection.data(), begin, end, partial.data() + t * 64);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // Bit j of the answer is the parity of plane j over all words
+    uint64_t result = 0;
+    for (uint64_t j = 0; j < d; j++) {
+        uint64_t plane = 0;
+        for (uint64_t t = 0; t < numThreads; t++) {
+            plane ^= partial[t * 64 + j];
+        }
+        result |= uint64_t(__builtin_popcountll(plane) & 1) << j;
+    }
+    return result;
+}
+
+// ============================================================================
+// Two-server DPF PIR
+// ============================================================================
+
+bool DPFPIRServer::Answer(const DPFKey& key, uint64_t& answer, DPFAnswerStats* stats) const {
+    // The key comes from the wire: its depth sizes the evaluation
+    if (key.party > 1 || key.depth != dpfDepthForDomain(db_.N)) {
+        std::cerr << "Error: DPF key rejected (party " << unsigned(key.party) << ", depth " << key.depth
+                  << ", expected " << dpfDepthForDomain(db_.N) << ")" << std::endl;
+        return false;
+    }
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<uint64_t> selection;
+    dpfEvalFull(key, selection, numThreads_);
+    auto mid_time = std::chrono::high_resolution_clock::now();
+
+    // The domain is a power of two, only the first numWords words matter
+    answer = db_.answer(selection, numThreads_);
+    auto end_time = std::chrono::high_resolution_clock::now();
+
+    if (stats) {
+        stats->evalMicros = std::chrono::duration_cast<std::chrono::microseconds>(mid_time - start_time).count();
+        stats->scanMicros = std::chrono::duration_cast<std::chrono::microseconds>(end_time - mid_time).count();
+    }
+    return true;
+}
+
+void DPFPIRClient::Query(uint64_t N, uint64_t index, DPFKey& key0, DPFKey& key1) {
+    dpfGen(index, dpfDepthForDomain(N), key0, key1);
+}
+
+// ============================================================================
+// Local server processes
+// ============================================================================
+
+bool LocalServerProcess::Start(const BitSlicedDatabase& db, uint64_t numThreads) {
+    // Server: length-prefixed keys in, (answer, stats) out, until EOF
+    return process_.Start("server", [&](int requests, int replies) {
+        DPFPIRServer server(db, numThreads);
+        uint64_t size = 0;
+        std::vector<uint8_t> bytes;
+        while (readAll(requests, &size, sizeof(size))) {
+            bytes.resize(size);
+            DPFKey key;
+            if (!readAll(requests, bytes.data(), size) || !DPFKey::deserialize(bytes.data(), size, key)) {
+                break;
+            }
+            DPFAnswerStats stats;
+            uint64_t answer = 0;
+            if (!server.Answer(key, answer, &stats)) {
+                break;
+            }
+            uint64_t reply[3] = {answer, stats.evalMicros, stats.scanMicros};
+            if (!writeAll(replies, reply, sizeof(reply))) {
+                break;
+            }
+        }
+    });
+}
+
+bool LocalServerProcess::Send(const DPFKey& key) {
+    std::vector<uint8_t> bytes = key.serialize();
+    uint64_t size = bytes.size();
+    return writeAll(process_.toChild(), &size, sizeof(size)) && writeAll(process_.toChild(), bytes.data(), size);
+}
+
+bool LocalServerProcess::Receive(uint64_t& answer, DPFAnswerStats& stats) {
+    uint64_t reply[3];
+    if (!readAll(process_.fromChild(), reply, sizeof(reply))) {
+        return false;
+    }
+    answer = reply[0];
+    stats.evalMicros = reply[1];
+    stats.scanMicros = reply[2];
+    return true;
+}
+
+void LocalServerProcess::Stop() {
+    process_.Stop();
+}
+
+// ============================================================================
+// Side-by-side benchmark
+// ============================================================================
+
+bool runTwoServerPIR(VLHEPIR& pir, uint64_t queryIndex, uint64_t numThreads) {
+    std::cout << "=== Two-server DPF PIR vs VLHEPIR ===" << std::endl;
+    Database& db = pir.db;
+    uint64_t d = pir.dbParams.d;
+    if (queryIndex >= db.N) {
+        std::cerr << "Error: query index " << queryIndex << " out of bounds (max: " << (db.N - 1) << ")" << std::endl;
+        return false;
+    }
+    if (!db.alloc) {
+        // Random generation mode keeps no entries, both engines need them here
+        fillRandomDatabase(db, d, queryIndex);
+    }
+    const uint64_t iters = 5;
+
+    // Two-server engine
+    BitSlicedDatabase sliced = BitSlicedDatabase::fromDatabase(db, d);
+    LocalServerProcess servers[2];
+    if (!servers[0].Start(sliced, numThreads) || !servers[1].Start(sliced, numThreads)) {
+        return false;
+    }
+
+    uint64_t result = 0;
+    uint64_t keyBytes = 0;
+    DPFAnswerStats stats[2];
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (uint64_t i = 0; i < iters; i++) {
+        DPFKey keys[2];
+        DPFPIRClient::Query(db.N, queryIndex, keys[0], keys[1]);
+        keyBytes = keys[0].serialize().size();
+        uint64_t answers[2];
+        // Both servers work concurrently, as remote servers would
+        if (!servers[0].Send(keys[0]) || !servers[1].Send(keys[1]) ||
+            !servers[0].Receive(answers[0], stats[0]) || !servers[1].Receive(answers[1], stats[1])) {
+            std::cerr << "Error: server process failed" << std::endl;
+            return false;
+        }
+        result = DPFPIRClient::Recover(answers[0], answers[1]);
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double dpfLatency = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0 / iters;
+    servers[0].Stop();
+    servers[1].Stop();
+
+    // Single-server engine on the same data
+    Matrix D = db.packDataInMatrix(pir.dbParams, false);
+    PIRKernels kernels = selectKernels(pir.dbParams);
+    KernelMatrix D_packed = kernels.pack(D);
+    Matrix A = pir.Init();
+    auto ct_sk = pir.Query(A, queryIndex);
+    start_time = std::chrono::high_resolution_clock::now();
+    for (uint64_t i = 0; i < iters; i++) {
+        kernels.answer(D_packed, std::get<0>(ct_sk), numThreads);
+    }
+    end_time = std::chrono::high_resolution_clock::now();
+    double lweAnswer = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0 / iters;
+
+    std::cout << "Database: " << db.N << " entries of " << d << " bits" << std::endl;
+    std::cout << "DPF (2 servers): key " << keyBytes << " bytes per server, eval "
+              << stats[0].evalMicros / 1000.0 << " ms + XOR scan " << stats[0].scanMicros / 1000.0
+              << " ms per server, end-to-end " << dpfLatency << " ms" << std::endl;
+    std::cout << "VLHEPIR (1 server): query " << std::get<0>(ct_sk).rows * sizeof(Elem) << " bytes, answer "
+              << lweAnswer << " ms (hint not included)" << std::endl;
+
+    uint64_t expected = db.getDataAtIndex(queryIndex).toUnsignedLong();
+    std::cout << "Recovered value: " << result << " (expected: " << expected << ")" << std::endl;
+    return result == expected;
+}
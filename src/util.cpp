@@ -0,0 +1,154 @@
+#include "util.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// ============================================================================
+// Descriptors
+// ============================================================================
+
+bool writeAll(int fd, const void* data, uint64_t bytes) {
+    const char* in = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = write(fd, in, bytes);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        in += n;
+        bytes -= n;
+    }
+    return true;
+}
+
+bool readAll(int fd, void* data, uint64_t bytes) {
+    char* out = static_cast<char*>(data);
+    while (bytes > 0) {
+        ssize_t n = read(fd, out, bytes);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        out += n;
+        bytes -= n;
+    }
+    return true;
+}
+
+bool writeAll(int fd, const void* data, uint64_t bytes, uint64_t offset) {
+    const char* in = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = pwrite(fd, in, bytes, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        in += n;
+        offset += n;
+        bytes -= n;
+    }
+    return true;
+}
+
+bool readAll(int fd, void* data, uint64_t bytes, uint64_t offset) {
+    char* out = static_cast<char*>(data);
+    while (bytes > 0) {
+        ssize_t n = pread(fd, out, bytes, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        out += n;
+        offset += n;
+        bytes -= n;
+    }
+    return true;
+}
+
+// ============================================================================
+// Server processes
+// ============================================================================
+
+/**
+ * Parent ends of the pipes of every running child
+ */
+static std::vector<int>& childPipeEnds() {
+    static std::vector<int> fds;
+    return fds;
+}
+
+bool ChildProcess::Start(const std::string& what, const std::function<void(int, int)>& serve) {
+    int request[2], response[2];
+    if (pipe(request) != 0) {
+        std::cerr << "Error: unable to create " << what << " pipes" << std::endl;
+        return false;
+    }
+    if (pipe(response) != 0) {
+        std::cerr << "Error: unable to create " << what << " pipes" << std::endl;
+        close(request[0]);
+        close(request[1]);
+        return false;
+    }
+
+    std::cout.flush();
+    pid_ = fork();
+    if (pid_ < 0) {
+        std::cerr << "Error: unable to start " << what << " process" << std::endl;
+        for (int fd : {request[0], request[1], response[0], response[1]}) {
+            close(fd);
+        }
+        return false;
+    }
+    if (pid_ == 0) {
+        close(request[1]);
+        close(response[0]);
+        for (int fd : childPipeEnds()) {
+            close(fd);
+        }
+        serve(request[0], response[1]);
+        _exit(0);
+    }
+
+    close(request[0]);
+    close(response[1]);
+    toChild_ = request[1];
+    fromChild_ = response[0];
+    childPipeEnds().push_back(toChild_);
+    childPipeEnds().push_back(fromChild_);
+    return true;
+}
+
+void ChildProcess::Stop() {
+    std::vector<int>& fds = childPipeEnds();
+    for (int fd : {toChild_, fromChild_}) {
+        if (fd < 0) continue;
+        fds.erase(std::remove(fds.begin(), fds.end(), fd), fds.end());
+        close(fd);
+    }
+    toChild_ = fromChild_ = -1;
+    if (pid_ > 0) {
+        waitpid(pid_, nullptr, 0);
+        pid_ = -1;
+    }
+}
+
+// ============================================================================
+// Reporting
+// ============================================================================
+
+double secondsSince(std::chrono::high_resolution_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+std::string formatBytes(uint64_t bytes) {
+    if (bytes < 1024) {
+        return std::to_string(bytes) + " B";
+    }
+    const char* units[] = {"KiB", "MiB", "GiB", "TiB"};
+    double value = bytes / 1024.0;
+    int unit = 0;
+    while (value >= 1024 && unit < 3) {
+        value /= 1024;
+        unit++;
+    }
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.1f %s", value, units[unit]);
+    return buffer;
+}